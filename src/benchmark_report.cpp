@@ -0,0 +1,135 @@
+// benchmark_report.cpp
+#include "benchmark_report.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+namespace {
+
+/* Percentil q ∈ [0,1] de amostras ordenadas (interpolação linear) */
+double percentile(const std::vector<double>& sorted, double q)
+{
+    const double position = q * static_cast<double>(sorted.size() - 1);
+    const std::size_t lower = static_cast<std::size_t>(position);
+    const std::size_t upper = std::min(lower + 1, sorted.size() - 1);
+    return sorted[lower] + (position - static_cast<double>(lower)) * (sorted[upper] - sorted[lower]);
+}
+
+std::string jsonString(const std::string& text)
+{
+    std::ostringstream out;
+    out << '"';
+    for (const char c : text)
+    {
+        switch (c)
+        {
+        case '"':  out << "\\\""; break;
+        case '\\': out << "\\\\"; break;
+        case '\n': out << "\\n";  break;
+        case '\t': out << "\\t";  break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20)
+                out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << int(c);
+            else
+                out << c;
+        }
+    }
+    out << '"';
+    return out.str();
+}
+
+/* Campo CSV: entre aspas se tiver separador, aspas ou quebra de linha */
+std::string csvField(const std::string& text)
+{
+    if (text.find_first_of(",\"\n") == std::string::npos) return text;
+    std::string quoted = "\"";
+    for (const char c : text)
+    {
+        if (c == '"') quoted += '"';
+        quoted += c;
+    }
+    return quoted + '"';
+}
+
+} // namespace
+
+SampleStats SampleStats::from(std::vector<double> samples)
+{
+    SampleStats stats;
+    stats.count = samples.size();
+    if (samples.empty()) return stats;
+
+    std::sort(samples.begin(), samples.end());
+    stats.min    = samples.front();
+    stats.max    = samples.back();
+    stats.median = percentile(samples, 0.50);
+    stats.p90    = percentile(samples, 0.90);
+    stats.p99    = percentile(samples, 0.99);
+
+    double sum = 0;
+    for (double sample : samples) sum += sample;
+    stats.mean = sum / static_cast<double>(samples.size());
+
+    if (samples.size() > 1)
+    {
+        double squares = 0;
+        for (double sample : samples) squares += (sample - stats.mean) * (sample - stats.mean);
+        stats.stddev = std::sqrt(squares / static_cast<double>(samples.size() - 1));
+    }
+    return stats;
+}
+
+void BenchmarkReport::writeJson(std::ostream& out) const
+{
+    out << std::setprecision(6) << std::defaultfloat;
+    out << "{\n  \"environment\": {";
+    for (std::size_t i = 0; i < environment_.size(); ++i)
+        out << (i ? ", " : "") << jsonString(environment_[i].first) << ": "
+            << jsonString(environment_[i].second);
+    out << "},\n  \"results\": [";
+
+    for (std::size_t i = 0; i < results_.size(); ++i)
+    {
+        const BenchmarkResult& r = results_[i];
+        out << (i ? ",\n" : "\n") << "    {"
+            << "\"benchmark\": " << jsonString(r.benchmark)
+            << ", \"prng\": "    << jsonString(r.prng)
+            << ", \"test\": "    << jsonString(r.test)
+            << ", \"bits\": "    << r.bits
+            << ", \"threads\": " << r.threads
+            << ", \"samples\": " << r.stats.count
+            << ", \"min_ms\": "  << r.stats.min
+            << ", \"median_ms\": " << r.stats.median
+            << ", \"p90_ms\": "  << r.stats.p90
+            << ", \"p99_ms\": "  << r.stats.p99
+            << ", \"max_ms\": "  << r.stats.max
+            << ", \"mean_ms\": " << r.stats.mean
+            << ", \"stddev_ms\": " << r.stats.stddev
+            << ", \"metrics\": {";
+        for (std::size_t m = 0; m < r.metrics.size(); ++m)
+            out << (m ? ", " : "") << jsonString(r.metrics[m].first) << ": " << r.metrics[m].second;
+        out << "}, \"note\": " << jsonString(r.note) << '}';
+    }
+    out << "\n  ]\n}\n";
+}
+
+void BenchmarkReport::writeCsv(std::ostream& out) const
+{
+    out << std::setprecision(6) << std::defaultfloat;
+    out << "benchmark,prng,test,bits,threads,samples,min_ms,median_ms,p90_ms,p99_ms,"
+           "max_ms,mean_ms,stddev_ms,metrics,note\n";
+    for (const BenchmarkResult& r : results_)
+    {
+        std::ostringstream metrics;
+        metrics << std::setprecision(6);
+        for (std::size_t m = 0; m < r.metrics.size(); ++m)
+            metrics << (m ? ";" : "") << r.metrics[m].first << '=' << r.metrics[m].second;
+
+        out << csvField(r.benchmark) << ',' << csvField(r.prng) << ',' << csvField(r.test) << ','
+            << r.bits << ',' << r.threads << ',' << r.stats.count << ','
+            << r.stats.min << ',' << r.stats.median << ',' << r.stats.p90 << ','
+            << r.stats.p99 << ',' << r.stats.max << ',' << r.stats.mean << ','
+            << r.stats.stddev << ',' << csvField(metrics.str()) << ',' << csvField(r.note) << '\n';
+    }
+}
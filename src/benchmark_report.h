@@ -0,0 +1,57 @@
+// benchmark_report.h
+#pragma once
+/*──────────────────────────────────────────────────────────────
+ *  Estatísticas de amostras e relatório dos benchmarks.
+ *
+ *  Cada medição vira um BenchmarkResult (amostras em ms + métricas
+ *  derivadas); o relatório é emitido como JSON ou CSV para comparar
+ *  versões e máquinas. As tabelas legíveis continuam em main.cpp.
+ *──────────────────────────────────────────────────────────────*/
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/* Resumo de uma série de amostras (mesma unidade das amostras) */
+struct SampleStats
+{
+    std::size_t count {0};
+    double min {0}, median {0}, p90 {0}, p99 {0}, max {0};
+    double mean {0}, stddev {0};                  // desvio-padrão amostral (n-1)
+
+    // Percentis por interpolação linear entre as amostras ordenadas
+    [[nodiscard]] static SampleStats from(std::vector<double> samples);
+};
+
+struct BenchmarkResult
+{
+    std::string benchmark;                        // "keygen", "prng_batch", ...
+    std::string prng;
+    std::string test;                             // vazio se não se aplica
+    unsigned    bits    {0};
+    unsigned    threads {0};
+    SampleStats stats;                            // em ms
+    std::vector<std::pair<std::string, double>> metrics;  // derivadas (MB/s, ...)
+    std::string note;                             // p.ex. prefixo do último primo
+};
+
+enum class ReportFormat { Table, Json, Csv };
+
+class BenchmarkReport
+{
+public:
+    void add(BenchmarkResult result) { results_.push_back(std::move(result)); }
+    [[nodiscard]] const std::vector<BenchmarkResult>& results() const noexcept { return results_; }
+
+    // Ambiente da execução (compilador, CPU, kernels) no cabeçalho do JSON
+    void setEnvironment(std::vector<std::pair<std::string, std::string>> environment)
+    { environment_ = std::move(environment); }
+
+    void writeJson(std::ostream& out) const;
+    void writeCsv(std::ostream& out) const;
+
+private:
+    std::vector<BenchmarkResult> results_;
+    std::vector<std::pair<std::string, std::string>> environment_;
+};
@@ -0,0 +1,68 @@
+// fixed_key_generator.cpp
+#include "fixed_key_generator.h"
+#include "pseudo_rng/random_bits.h"
+#include <algorithm>
+#include <stdexcept>
+
+template <unsigned Bits, class Prng, class Tester>
+FixedKeyGenerator<Bits, Prng, Tester>::FixedKeyGenerator(int primalityIter)
+    : primalityIterations_(primalityIter),
+      trialDivision_(TrialDivisionEngine::forBits(Bits))
+{
+    if (primalityIterations_ <= 0)
+        throw std::invalid_argument("Iterations must be positive");
+}
+
+template <unsigned Bits, class Prng, class Tester>
+void FixedKeyGenerator<Bits, Prng, Tester>::generateCandidate(FixedInt& candidate)
+{
+    using Limb = boost::multiprecision::limb_type;
+    constexpr unsigned LIMB_BITS = sizeof(Limb) * 8;
+    constexpr unsigned LIMBS     = Bits / LIMB_BITS;
+
+    /* Mesma ordem de palavras de fillRandomBits ⇒ mesmo candidato
+       que KeyGenerator::generateCandidate */
+    auto& backend = candidate.backend();
+    backend.resize(LIMBS, LIMBS);
+    Limb* limbs = backend.limbs();
+    fillRandomLimbs(prng_, Bits, limbs);
+    limbs[0]         |= 1;                                   // ímpar
+    limbs[LIMBS - 1] |= Limb(1) << (LIMB_BITS - 1);           // bit alto
+    backend.normalize();
+}
+
+template <unsigned Bits, class Prng, class Tester>
+typename FixedKeyGenerator<Bits, Prng, Tester>::FixedInt
+FixedKeyGenerator<Bits, Prng, Tester>::generateKey(uint_fast32_t seed)
+{
+    prng_.Prng::setSeed(seed);
+
+    FixedInt candidate;
+    for (;;)
+    {
+        generateCandidate(candidate);
+
+        /* Filtro barato direto nos limbs fixos; o teste (que repete a
+           divisão por tentativa) só vê os sobreviventes */
+        const auto& backend = candidate.backend();
+        if (trialDivision_.hasSmallFactor(backend.limbs(), backend.size()))
+            continue;
+
+        auto& bigBackend = candidateForTest_.backend();
+        bigBackend.resize(backend.size(), backend.size());
+        std::copy(backend.limbs(), backend.limbs() + backend.size(), bigBackend.limbs());
+        bigBackend.sign(false);
+        bigBackend.normalize();
+
+        if (tester_.Tester::isPrime(candidateForTest_, primalityIterations_, prng_))
+            return candidate;
+    }
+}
+
+#define FIXED_KEY_GENERATOR_INSTANTIATE(Bits, Prng, Tester) \
+    template class FixedKeyGenerator<Bits, Prng, Tester>;
+
+FIXED_KEY_GENERATOR_INSTANCES(FIXED_KEY_GENERATOR_INSTANTIATE, MersenneTwister, MillerRabinTest)
+FIXED_KEY_GENERATOR_INSTANCES(FIXED_KEY_GENERATOR_INSTANTIATE, MersenneTwister, BailliePSWTest)
+FIXED_KEY_GENERATOR_INSTANCES(FIXED_KEY_GENERATOR_INSTANTIATE, ChaCha20PRNG,    MillerRabinTest)
+FIXED_KEY_GENERATOR_INSTANCES(FIXED_KEY_GENERATOR_INSTANTIATE, ChaCha20PRNG,    BailliePSWTest)
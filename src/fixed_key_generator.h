@@ -0,0 +1,83 @@
+// fixed_key_generator.h
+#pragma once
+/*──────────────────────────────────────────────────────────────
+ *  FixedKeyGenerator<Bits, Prng, Tester>  –  KeyGenerator com
+ *  tamanho, PRNG e teste fixados em tempo de compilação.
+ *
+ *  O candidato vive num inteiro de largura fixa (limbs na pilha, sem
+ *  alocação), os limbs saem direto de Prng::fill() e o filtro por
+ *  divisão por tentativa roda sobre eles; só os sobreviventes viram
+ *  BigInt para o teste. Prng e Tester são classes final, então as
+ *  chamadas a fill()/isPrime() não passam pela vtable.
+ *
+ *  Mesma semente ⇒ mesmo primo que KeyGenerator (modo Random, sequencial)
+ *  com o mesmo PRNG, teste, tamanho e número de iterações; a seção
+ *  "fixed" do benchmark confere isso e mede os dois lado a lado (o
+ *  ganho é pequeno: a exponenciação modular domina o tempo).
+ *
+ *  Instanciado em fixed_key_generator.cpp para 1024/2048/3072/4096 bits ×
+ *  {MersenneTwister, ChaCha20PRNG} × {MillerRabinTest, BailliePSWTest}.
+ *──────────────────────────────────────────────────────────────*/
+#include "pseudo_rng/prng.h"
+#include "pseudo_rng/mersenne_twister.h"
+#include "pseudo_rng/chacha20_prng.h"
+#include "primality_test/primality_test.h"
+#include "primality_test/miller_rabin_test.h"
+#include "primality_test/baillie_psw_test.h"
+#include "trial_division.h"
+#include <boost/multiprecision/cpp_int.hpp>
+#include <cstdint>
+#include <type_traits>
+
+using BigInt = boost::multiprecision::cpp_int;
+
+template <unsigned Bits, class Prng, class Tester>
+class FixedKeyGenerator
+{
+    static_assert(Bits >= 64 && Bits % 64 == 0, "Bits must be a multiple of 64");
+    static_assert(std::is_base_of_v<PRNG, Prng> && std::is_final_v<Prng>,
+                  "Prng must be a final PRNG");
+    static_assert(std::is_base_of_v<PrimalityTest, Tester> && std::is_final_v<Tester>,
+                  "Tester must be a final PrimalityTest");
+
+public:
+    /* Inteiro sem sinal de exatamente Bits bits (limbs inline) */
+    using FixedInt = boost::multiprecision::number<
+        boost::multiprecision::cpp_int_backend<
+            Bits, Bits,
+            boost::multiprecision::unsigned_magnitude,
+            boost::multiprecision::unchecked, void>>;
+
+    static constexpr unsigned KEY_BITS = Bits;
+
+    explicit FixedKeyGenerator(int primalityIter = 64);
+
+    // Gera um primo de Bits bits (thread única)
+    [[nodiscard]] FixedInt generateKey(uint_fast32_t seed);
+
+    // Escreve um candidato (ímpar, MSB set) em  candidate  com o PRNG interno
+    void generateCandidate(FixedInt& candidate);
+
+private:
+    const int primalityIterations_;          // Iterações do teste
+    Prng prng_;                              // por valor: sem clone/vtable
+    Tester tester_;
+    const TrialDivisionEngine& trialDivision_;
+    BigInt candidateForTest_;                // reaproveitado entre candidatos
+};
+
+#define FIXED_KEY_GENERATOR_INSTANCES(MACRO, Prng, Tester) \
+    MACRO(1024, Prng, Tester)                              \
+    MACRO(2048, Prng, Tester)                              \
+    MACRO(3072, Prng, Tester)                              \
+    MACRO(4096, Prng, Tester)
+
+#define FIXED_KEY_GENERATOR_EXTERN(Bits, Prng, Tester) \
+    extern template class FixedKeyGenerator<Bits, Prng, Tester>;
+
+FIXED_KEY_GENERATOR_INSTANCES(FIXED_KEY_GENERATOR_EXTERN, MersenneTwister, MillerRabinTest)
+FIXED_KEY_GENERATOR_INSTANCES(FIXED_KEY_GENERATOR_EXTERN, MersenneTwister, BailliePSWTest)
+FIXED_KEY_GENERATOR_INSTANCES(FIXED_KEY_GENERATOR_EXTERN, ChaCha20PRNG,    MillerRabinTest)
+FIXED_KEY_GENERATOR_INSTANCES(FIXED_KEY_GENERATOR_EXTERN, ChaCha20PRNG,    BailliePSWTest)
+
+#undef FIXED_KEY_GENERATOR_EXTERN
@@ -0,0 +1,103 @@
+/*──────────────────────────────────────────────────────────────
+ *  IncrementalSieve  –  crivo de janela sobre  start + 2k.
+ *
+ *  Para cada primo pequeno p (ímpar) guardamos  r = start mod p.
+ *  O deslocamento k torna  start + 2k ≡ 0 (mod p)  quando
+ *      k ≡ (p - r) · 2⁻¹  (mod p),   com  2⁻¹ = (p + 1) / 2.
+ *  Marcamos  k, k + p, k + 2p, …  dentro da janela.
+ *
+ *  Primo seguro: também  2(start + 2k) + 1 ≡ 0 (mod p)  quando
+ *      k ≡ -(2r + 1) · 4⁻¹  (mod p),   com  4⁻¹ = (2⁻¹)².
+ *──────────────────────────────────────────────────────────────*/
+#include "incremental_sieve.h"
+#include <stdexcept>
+
+IncrementalSieve::IncrementalSieve(unsigned keyBits, unsigned windowSize, bool safePrime)
+    : keyBits_(keyBits),
+      windowSize_(windowSize),
+      safePrime_(safePrime),
+      primeTable_(TrialDivisionEngine::forBits(safePrime ? keyBits + 1 : keyBits)),
+      compositeBits_((windowSize + 63) / 64)
+{
+    if (keyBits_ < 2)
+        throw std::invalid_argument("keyBits must be ≥ 2");
+    if (windowSize_ == 0)
+        throw std::invalid_argument("windowSize must be positive");
+    residues_.reserve(primeTable_.oddPrimes().size());
+}
+
+void IncrementalSieve::reset(const BigInt& oddStart)
+{
+    windowBase_ = oddStart;
+    primeTable_.computeResidues(windowBase_, residues_);
+    sieveWindow();
+}
+
+void IncrementalSieve::sieveWindow()
+{
+    std::fill(compositeBits_.begin(), compositeBits_.end(), 0);
+
+    /* Janelas que alcançam a própria tabela (chaves muito pequenas) */
+    const std::vector<uint32_t>& primes = primeTable_.oddPrimes();
+    const bool baseIsSmall = windowBase_ <= primeTable_.primeBound();
+    const uint64_t smallBase =
+        baseIsSmall ? static_cast<uint64_t>(windowBase_) : 0;
+
+    for (std::size_t i = 0; i < residues_.size(); ++i)
+    {
+        const uint32_t p = primes[i];
+        const uint64_t halfInverse = (p + 1) / 2;
+        uint64_t offset = ((p - residues_[i]) % p) * halfInverse % p;
+
+        /* Não descartar o próprio primo p */
+        if (baseIsSmall && smallBase + 2 * offset == p)
+            offset += p;
+
+        for (; offset < windowSize_; offset += p)
+            compositeBits_[offset / 64] |= uint64_t{1} << (offset % 64);
+
+        if (!safePrime_) continue;
+        /* 2q + 1 ≡ 0 (mod p)  (p = 2q + 1 pequeno também é preservado) */
+        const uint64_t quarterInverse = halfInverse * halfInverse % p;
+        offset = ((p - (2ull * residues_[i] + 1) % p) % p) * quarterInverse % p;
+        if (baseIsSmall && 2 * (smallBase + 2 * offset) + 1 == p)
+            offset += p;
+        for (; offset < windowSize_; offset += p)
+            compositeBits_[offset / 64] |= uint64_t{1} << (offset % 64);
+    }
+    cursor_ = 0;
+}
+
+void IncrementalSieve::advanceWindow()
+{
+    const std::vector<uint32_t>& primes = primeTable_.oddPrimes();
+    const uint64_t step = 2ull * windowSize_;
+    windowBase_ += step;
+    for (std::size_t i = 0; i < residues_.size(); ++i)
+    {
+        const uint32_t p = primes[i];
+        residues_[i] = static_cast<uint32_t>((residues_[i] + step) % p);
+    }
+    sieveWindow();
+}
+
+bool IncrementalSieve::nextSurvivor(BigInt& candidate)
+{
+    while (true)
+    {
+        while (cursor_ < windowSize_)
+        {
+            const unsigned offset = cursor_++;
+            if (compositeBits_[offset / 64] & (uint64_t{1} << (offset % 64)))
+                continue;
+
+            candidate = windowBase_;
+            candidate += 2ull * offset;
+            /* Passou do tamanho pedido ⇒ precisa de novo ponto de partida */
+            if (boost::multiprecision::msb(candidate) >= keyBits_)
+                return false;
+            return true;
+        }
+        advanceWindow();
+    }
+}
@@ -0,0 +1,57 @@
+// incremental_sieve.h
+#pragma once
+#include "trial_division.h"
+#include <boost/multiprecision/cpp_int.hpp>
+#include <cstdint>
+#include <vector>
+
+using BigInt = boost::multiprecision::cpp_int;
+
+/* =========================================================================
+   Busca incremental de candidatos a primo.
+   -------------------------------------------------------------------------
+   A partir de um único ponto ímpar  start  calcula uma vez os resíduos
+   start mod p  para a tabela de primos do TrialDivisionEngine (limite
+   escolhido pelo tamanho da chave) e peneira uma janela de
+   deslocamentos  start + 2k  num vetor de bits. Apenas os sobreviventes
+   precisam passar pelo PrimalityTest; ao esgotar a janela os resíduos são
+   avançados com aritmética nativa, sem novas divisões de BigInt.
+
+   No modo de primo seguro os candidatos são  q  e o crivo é conjunto:
+   q  é descartado se  q  ou  2q + 1  tiver fator primo pequeno.
+   ========================================================================= */
+class IncrementalSieve
+{
+public:
+    static constexpr unsigned DEFAULT_WINDOW = 4096;   // deslocamentos por janela
+
+    // safePrime: crivo conjunto de  q  (keyBits bits) e  2q + 1
+    explicit IncrementalSieve(unsigned keyBits,
+                              unsigned windowSize = DEFAULT_WINDOW,
+                              bool safePrime = false);
+
+    [[nodiscard]] bool safePrime() const noexcept { return safePrime_; }
+
+    // Reinicia a busca a partir de um novo ponto ímpar com  keyBits  bits.
+    void reset(const BigInt& oddStart);
+
+    // Copia em  candidate  o próximo sobrevivente do crivo.
+    // Retorna false quando a busca ultrapassa  keyBits  bits (requer reset).
+    [[nodiscard]] bool nextSurvivor(BigInt& candidate);
+
+private:
+    // Marca os múltiplos de primos pequenos na janela atual.
+    void sieveWindow();
+    // Avança a janela em  2·windowSize_  atualizando os resíduos.
+    void advanceWindow();
+
+    unsigned keyBits_;
+    unsigned windowSize_;
+    bool safePrime_;
+    const TrialDivisionEngine& primeTable_;
+
+    BigInt windowBase_;                    // start da janela corrente
+    std::vector<uint32_t> residues_;       // windowBase_ mod p (p ímpar)
+    std::vector<uint64_t> compositeBits_;  // bit k ⇒ windowBase_ + 2k composto
+    unsigned cursor_ {0};                  // próximo deslocamento a examinar
+};
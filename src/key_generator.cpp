@@ -2,10 +2,68 @@
  *  KeyGenerator  –  encontra número primo de  keyBits_  bits.
  *──────────────────────────────────────────────────────────────*/
 #include "key_generator.h"
+#include "pseudo_rng/random_bits.h"
+#include "primality_test/base2_fermat.h"
 #include <atomic>
+#include <chrono>
 #include <future>
-#include <thread>
 #include <iostream>
+#include <limits>
+#include <mutex>
+#include <numeric>
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+uint64_t nanosecondsBetween(Clock::time_point from, Clock::time_point to) noexcept
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(to - from).count());
+}
+
+/* Semente das testemunhas do candidato  index  (mistura splitmix64) */
+uint_fast32_t witnessSeed(uint_fast32_t seed, uint64_t index) noexcept
+{
+    uint64_t z = (static_cast<uint64_t>(seed) << 32) ^ index;
+    z += 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return static_cast<uint_fast32_t>((z ^ (z >> 31)) & 0xFFFFFFFFu);
+}
+
+/* Semeia o PRNG alvo só na primeira chamada de generate(): candidatos
+   descartados pela divisão por tentativa não pagam o setSeed. */
+class DeferredSeedPRNG final : public PRNG
+{
+public:
+    DeferredSeedPRNG(PRNG& target, uint_fast32_t seed) : PRNG(seed), target_(target) {}
+
+    uint_fast32_t generate() override
+    {
+        if (!seeded_) { target_.setSeed(seed_); seeded_ = true; }
+        return target_.generate();
+    }
+    void fill(uint32_t* out, std::size_t count) override
+    {
+        if (!seeded_) { target_.setSeed(seed_); seeded_ = true; }
+        target_.fill(out, count);
+    }
+    void setSeed(uint_fast32_t newSeed) override
+    {
+        PRNG::setSeed(newSeed);
+        seeded_ = false;
+    }
+    std::unique_ptr<PRNG> clone() const override
+    {
+        auto copy = target_.clone();
+        if (!seeded_) copy->setSeed(seed_);
+        return copy;
+    }
+
+private:
+    PRNG& target_;
+    bool  seeded_ {false};
+};
+} // namespace
 
 KeyGenerator::KeyGenerator(std::unique_ptr<PRNG> masterPRNG,
                            PrimalityTest*       primalityTester,
@@ -14,7 +72,8 @@ KeyGenerator::KeyGenerator(std::unique_ptr<PRNG> masterPRNG,
     : primalityIterations_(primalityIterations),
       prng_(std::move(masterPRNG)),
       primalityTester_(primalityTester),
-      keyBits_(keySizeBits)
+      keyBits_(keySizeBits),
+      threadCount_(0)
 {
     if (!prng_ || !primalityTester_)
         throw std::invalid_argument("Null pointer");
@@ -24,75 +83,475 @@ KeyGenerator::KeyGenerator(std::unique_ptr<PRNG> masterPRNG,
         throw std::invalid_argument("Iterations must be positive");
 }
 
-BigInt KeyGenerator::generateCandidate(PRNG& localPRNG)
+void KeyGenerator::setGenerator(std::unique_ptr<PRNG> newPrng)
+{
+    if (!newPrng)
+        throw std::invalid_argument("Null pointer");
+    prng_ = std::move(newPrng);
+    for (auto& state : workerStates_) state.prng.reset();   // reclonados sob demanda
+    sequentialWitnessPrng_.reset();
+}
+
+void KeyGenerator::setTester(PrimalityTest* newTester)
+{
+    if (!newTester)
+        throw std::invalid_argument("Null pointer");
+    primalityTester_ = newTester;
+}
+
+void KeyGenerator::setThreadCount(unsigned threadCount)
+{
+    threadCount_ = threadCount;
+    pool_.reset();
+    workerStates_.clear();
+}
+
+void KeyGenerator::setStreamSpacing(unsigned log2Steps)
+{
+    if (log2Steps > 48)                                  // deixa 2^16 fluxos
+        throw std::invalid_argument("log2Steps must be ≤ 48");
+    streamSpacingLog2_ = log2Steps;
+}
+
+void KeyGenerator::setSafePrime(bool enabled)
+{
+    if (enabled && keyBits_ < 3)
+        throw std::invalid_argument("safe primes need keySizeBits ≥ 3");
+    safePrime_ = enabled;
+}
+
+void KeyGenerator::setCoprimeExponent(uint64_t exponent) noexcept
+{
+    coprimeExponent_ = exponent;
+}
+
+void KeyGenerator::setTopBits(unsigned count)
+{
+    if (count < 1 || count > 2)
+        throw std::invalid_argument("top bit count must be 1 or 2");
+    if (count == 2 && candidateBits() < 3)
+        throw std::invalid_argument("two top bits need candidates of ≥ 3 bits");
+    topBits_ = count;
+}
+
+void KeyGenerator::setThreadPool(std::shared_ptr<WorkStealingPool> pool)
+{
+    if (!pool)
+        throw std::invalid_argument("Null pointer");
+    pool_ = std::move(pool);
+    threadCount_ = pool_->size();
+    workerStates_.clear();
+    workerStates_.resize(pool_->size());
+}
+
+void KeyGenerator::generateCandidate(PRNG& localPRNG, BigInt& candidate) const
+{
+    const unsigned bits = candidateBits();
+    fillRandomBits(localPRNG, bits, candidate);
+    boost::multiprecision::bit_set(candidate, 0);               // ímpar
+    boost::multiprecision::bit_set(candidate, bits-1);  // bit alto
+    if (topBits_ == 2)
+        boost::multiprecision::bit_set(candidate, bits-2);
+}
+
+bool KeyGenerator::coprimeToExponent(const BigInt& prime) const
+{
+    if (coprimeExponent_ <= 1) return true;
+    /* gcd(p - 1, e) = gcd((p - 1) mod e, e): um resto por limb, sem BigInt */
+    const uint64_t residue = boost::multiprecision::integer_modulus(prime, coprimeExponent_);
+    return std::gcd((residue + coprimeExponent_ - 1) % coprimeExponent_, coprimeExponent_) == 1;
+}
+
+std::unique_ptr<IncrementalSieve>& KeyGenerator::sieveFor(std::unique_ptr<IncrementalSieve>& sieve) const
+{
+    if (!sieve || sieve->safePrime() != safePrime_)
+        sieve = std::make_unique<IncrementalSieve>(candidateBits(),
+                                                   IncrementalSieve::DEFAULT_WINDOW, safePrime_);
+    return sieve;
+}
+
+bool KeyGenerator::passesTests(BigInt& candidate, PRNG& witnessPRNG,
+                               const CancellationToken& cancel)
 {
-    const unsigned bitsPerCall = 32;
-    BigInt candidate{0};
-    unsigned accumulatedBits = 0;
+    if (!safePrime_)
+        return coprimeToExponent(candidate) &&
+               primalityTester_->isPrime(candidate, primalityIterations_, witnessPRNG, cancel);
 
-    while (accumulatedBits < keyBits_)
+    /* candidate = q. Fermat na base 2 em q e em 2q+1 (só quadrados e
+       dobras) antes das rodadas completas: quase todo par sem fator
+       pequeno cai aqui, e as rodadas caras só rodam para os raros pares
+       que passam nos dois */
+    BigInt safeCandidate = candidate;
+    safeCandidate <<= 1;
+    safeCandidate += 1;
+    if (!coprimeToExponent(safeCandidate) ||
+        !isBase2FermatProbablePrime(candidate, cancel) ||
+        !isBase2FermatProbablePrime(safeCandidate, cancel))
+        return false;
+    if (!primalityTester_->isPrime(candidate, primalityIterations_, witnessPRNG, cancel) ||
+        !primalityTester_->isPrime(safeCandidate, primalityIterations_, witnessPRNG, cancel))
+        return false;
+    candidate = std::move(safeCandidate);
+    return true;
+}
+
+bool KeyGenerator::searchPrime(PRNG& localPRNG,
+                               std::unique_ptr<IncrementalSieve>& sieve,
+                               BigInt& prime,
+                               const std::atomic<bool>* stop)
+{
+    auto stopRequested = [stop] {
+        return stop && stop->load(std::memory_order_acquire);
+    };
+    /* Os testes também observam  stop  (entre rodadas e dentro da
+       exponenciação), para que os perdedores parem sem esperar a rodada */
+    const CancellationToken cancel = stop ? CancellationToken(*stop)
+                                          : CancellationToken{};
+
+    if (searchMode_ == CandidateSearch::Random && !safePrime_)
     {
-        uint32_t chunk = localPRNG.generate();
-        unsigned take =
-            std::min(bitsPerCall, keyBits_ - accumulatedBits);
-        uint32_t mask =
-            (take == 32) ? 0xFFFFFFFFu : ((1u << take) - 1u);
+        while (!stopRequested())
+        {
+            generateCandidate(localPRNG, prime);
+            keygen_stats::add(&KeyGenerationStats::candidatesGenerated);
+            if (passesTests(prime, localPRNG, cancel))
+                return true;
+        }
+        return false;
+    }
 
-        candidate |= BigInt(chunk & mask) << accumulatedBits;
-        accumulatedBits += take;
+    /* Incremental (e todo primo seguro): um start aleatório, sobreviventes
+       do crivo em ordem */
+    sieveFor(sieve);
+    BigInt start;
+    while (!stopRequested())
+    {
+        generateCandidate(localPRNG, start);
+        sieve->reset(start);
+        while (!stopRequested() && sieve->nextSurvivor(prime))
+        {
+            keygen_stats::add(&KeyGenerationStats::candidatesGenerated);
+            if (passesTests(prime, localPRNG, cancel))
+                return true;
+        }
     }
+    return false;
+}
 
-    boost::multiprecision::bit_set(candidate, 0);               // ímpar
-    boost::multiprecision::bit_set(candidate, keyBits_-1);  // bit alto
-    return candidate;
+void KeyGenerator::ensurePool()
+{
+    if (pool_) return;
+    pool_ = std::make_shared<WorkStealingPool>(threadCount_);
+    workerStates_.clear();
+    workerStates_.resize(pool_->size());
+}
+
+void KeyGenerator::runSearches(unsigned searchCount,
+                               const std::function<void(unsigned, unsigned)>& search,
+                               KeyGenerationStats& stats)
+{
+    std::vector<KeyGenerationStats> searchStats(searchCount);
+    std::vector<Clock::time_point>  finishedAt(searchCount);
+    const auto submittedAt = KeyGenerationStats::enabled ? Clock::now() : Clock::time_point{};
+
+    std::vector<std::future<void>> searches;
+    searches.reserve(searchCount);
+    for (unsigned t = 0; t < searchCount; ++t)
+        searches.push_back(pool_->submit([&, t](unsigned worker)
+        {
+            if constexpr (KeyGenerationStats::enabled)
+                searchStats[t].threadStartNanoseconds = nanosecondsBetween(submittedAt, Clock::now());
+            keygen_stats::Scope scope(searchStats[t]);
+            search(t, worker);
+            if constexpr (KeyGenerationStats::enabled)
+                finishedAt[t] = Clock::now();
+        }));
+
+    /* Espera todas (referenciam esta pilha) antes de propagar exceções */
+    for (auto& pending : searches) pending.wait();
+    if constexpr (KeyGenerationStats::enabled)
+    {
+        /* Junção: da primeira busca encerrada (em geral a vencedora) até
+           a última thread devolver o controle */
+        const auto joinedAt = Clock::now();
+        auto firstFinished = joinedAt;
+        for (const auto& finished : finishedAt)
+            if (finished != Clock::time_point{} && finished < firstFinished) firstFinished = finished;
+        for (const auto& local : searchStats) stats += local;
+        stats.threadJoinNanoseconds += nanosecondsBetween(firstFinished, joinedAt);
+    }
+    stats.searches += searchCount;
+    for (auto& pending : searches) pending.get();
 }
 
 BigInt KeyGenerator::generateKey(uint_fast32_t seed)
 {
+    return generateKeyWithStats(seed).key;
+}
+
+BigInt KeyGenerator::generateKeyConcurrent(uint_fast32_t seed)
+{
+    return generateKeyConcurrentWithStats(seed).key;
+}
+
+KeyGenerationResult KeyGenerator::generateKeyWithStats(uint_fast32_t seed)
+{
+    KeyGenerationResult result;
+    const auto start = KeyGenerationStats::enabled ? Clock::now() : Clock::time_point{};
+    {
+        keygen_stats::Scope scope(result.stats);
+        if (deterministic_)
+            result.key = generateKeyDeterministic(seed);
+        else
+        {
+            prng_->setSeed(seed);
+            searchPrime(*prng_, sequentialSieve_, result.key);
+        }
+    }
+    result.stats.searches = 1;
+    if constexpr (KeyGenerationStats::enabled)
+        result.stats.elapsedNanoseconds = nanosecondsBetween(start, Clock::now());
+    return result;
+}
+
+bool KeyGenerator::generateKeyFromStream(const std::atomic<bool>& stop, BigInt& key)
+{
+    return searchPrime(*prng_, sequentialSieve_, key, &stop);
+}
+
+KeyGenerationResult KeyGenerator::generateKeyConcurrentWithStats(uint_fast32_t seed)
+{
+    KeyGenerationResult result;
+    const auto start = KeyGenerationStats::enabled ? Clock::now() : Clock::time_point{};
+    result.key = deterministic_ ? generateKeyDeterministicConcurrent(seed, result.stats)
+                                : generateKeyRandomConcurrent(seed, result.stats);
+    if constexpr (KeyGenerationStats::enabled)
+        result.stats.elapsedNanoseconds = nanosecondsBetween(start, Clock::now());
+    return result;
+}
+
+BigInt KeyGenerator::generateKeyRandomConcurrent(uint_fast32_t seed, KeyGenerationStats& stats)
+{
+    ensurePool();
+    const unsigned searchCount = pool_->size();
+
+    std::atomic<bool> primeFound{false};
+    BigInt            primeResult;
+
+    auto search = [&](unsigned searchIndex, unsigned workerIndex)
+    {
+        SearchState& state = seedSearch(workerIndex, seed, searchIndex);
+        try {
+            BigInt candidate;
+            if (searchPrime(*state.prng, state.sieve, candidate, &primeFound) &&
+                !primeFound.exchange(true))
+                primeResult = std::move(candidate);
+        } catch (...) {
+            primeFound.store(true);                      // interrompe as demais buscas
+            throw;
+        }
+    };
+
+    runSearches(searchCount, search, stats);
+    return primeResult;
+}
+
+KeyGenerator::SearchState& KeyGenerator::seedSearch(unsigned workerIndex, uint_fast32_t seed,
+                                                    unsigned searchIndex)
+{
+    /* A busca t usa a semente  seed + t  (ou  seed  avançada t·2^k
+       palavras, ver setStreamSpacing) no PRNG do worker que a executar
+       (o estado é do worker, não da busca). */
+    SearchState& state = workerStates_[workerIndex];
+    if (!state.prng) state.prng = prng_->clone();
+    if (streamSpacingLog2_ == 0)
+        state.prng->setSeed(static_cast<uint_fast32_t>(seed + searchIndex));
+    else
+    {
+        state.prng->setSeed(seed);
+        state.prng->discard(static_cast<uint64_t>(searchIndex) << streamSpacingLog2_);
+    }
+    return state;
+}
+
+std::vector<BigInt> KeyGenerator::generateKeysConcurrent(uint_fast32_t seed, unsigned count,
+                                                         KeyGenerationStats* stats)
+{
+    KeyGenerationStats local;
+    const auto start = KeyGenerationStats::enabled ? Clock::now() : Clock::time_point{};
+    std::vector<BigInt> primes;
+    primes.reserve(count);
+
+    if (deterministic_)
+    {
+        /* Reprodutível: uma busca determinística por primo, sementes seed + i */
+        for (unsigned i = 0; i < count; ++i)
+            primes.push_back(generateKeyDeterministicConcurrent(
+                static_cast<uint_fast32_t>(seed + i), local));
+    }
+    else if (count > 0)
+    {
+        ensurePool();
+        std::atomic<bool> enough{false};
+        std::mutex        resultMutex;
+
+        /* Todas as buscas seguem até haver  count  primos: quem acha um
+           continua procurando, e o último a completar a conta para as demais */
+        auto search = [&](unsigned searchIndex, unsigned workerIndex)
+        {
+            SearchState& state = seedSearch(workerIndex, seed, searchIndex);
+            try {
+                BigInt candidate;
+                while (searchPrime(*state.prng, state.sieve, candidate, &enough))
+                {
+                    std::lock_guard<std::mutex> lock(resultMutex);
+                    if (primes.size() < count) primes.push_back(candidate);
+                    if (primes.size() == count)
+                    {
+                        enough.store(true);
+                        return;
+                    }
+                }
+            } catch (...) {
+                enough.store(true);
+                throw;
+            }
+        };
+        runSearches(pool_->size(), search, local);
+    }
+
+    if constexpr (KeyGenerationStats::enabled)
+        local.elapsedNanoseconds = nanosecondsBetween(start, Clock::now());
+    if (stats) *stats = local;
+    return primes;
+}
+
+/*──────────── Modo determinístico ────────────*/
+
+uint64_t KeyGenerator::nextCandidate(PRNG& stream, CandidateCursor& cursor,
+                                     BigInt& candidate)
+{
+    if (searchMode_ == CandidateSearch::Random && !safePrime_)
+        generateCandidate(stream, candidate);
+    else
+    {
+        sieveFor(sequentialSieve_);
+        while (!cursor.sieveStarted || !sequentialSieve_->nextSurvivor(candidate))
+        {
+            generateCandidate(stream, candidate);
+            sequentialSieve_->reset(candidate);
+            cursor.sieveStarted = true;
+        }
+    }
+    keygen_stats::add(&KeyGenerationStats::candidatesGenerated);
+    return cursor.nextIndex++;
+}
+
+BigInt KeyGenerator::generateKeyDeterministic(uint_fast32_t seed)
+{
+    if (!sequentialWitnessPrng_) sequentialWitnessPrng_ = prng_->clone();
     prng_->setSeed(seed);
+
+    CandidateCursor cursor;
+    BigInt candidate;
     while (true)
     {
-        BigInt potentialPrime = generateCandidate(*prng_);
-        if (primalityTester_->isPrime(potentialPrime,
-                                      primalityIterations_,
-                                      *prng_))
-            return potentialPrime;
+        const uint64_t index = nextCandidate(*prng_, cursor, candidate);
+        DeferredSeedPRNG witnessPRNG(*sequentialWitnessPrng_, witnessSeed(seed, index));
+        if (passesTests(candidate, witnessPRNG, CancellationToken{}))
+            return candidate;
     }
 }
 
-BigInt KeyGenerator::generateKeyConcurrent(uint_fast32_t seed)
+BigInt KeyGenerator::generateKeyDeterministicConcurrent(uint_fast32_t seed,
+                                                        KeyGenerationStats& stats)
 {
-    unsigned threadCount =
-        std::max(1u, std::thread::hardware_concurrency() / 2);
+    ensurePool();
+    const unsigned searchCount = pool_->size();
+    /* Candidatos pequenos são testados rápido: lotes maiores diluem o lock */
+    const unsigned batchSize = (keyBits_ <= 256) ? 16 : (keyBits_ <= 1024) ? 4 : 1;
+    constexpr uint64_t NO_INDEX = std::numeric_limits<uint64_t>::max();
 
-    std::promise<BigInt> firstPrimePromise;
-    std::future<BigInt>  firstPrimeFuture = firstPrimePromise.get_future();
-    std::atomic<bool>    primeFound{false};
+    /* Clones feitos aqui: durante a busca prng_ só é lido sob streamMutex */
+    for (auto& state : workerStates_)
+        if (!state.prng) state.prng = prng_->clone();
 
-    auto worker = [&](uint_fast32_t threadSeed)
+    /* Fluxo de candidatos: prng_ semeado com  seed, como em generateKey */
+    prng_->setSeed(seed);
+    CandidateCursor cursor;
+    std::mutex      streamMutex;                       // protege prng_, cursor e crivo
+
+    std::atomic<uint64_t> bestIndex{NO_INDEX};
+    std::atomic<bool>     aborted{false};
+    std::mutex            resultMutex;
+    BigInt                primeResult;
+
+    /* Índice em teste por busca; quem publica um primo cancela os maiores */
+    struct Slot
     {
-        auto localPRNG = prng_->clone();
-        localPRNG->setSeed(threadSeed);
+        std::atomic<uint64_t> current {NO_INDEX};
+        std::atomic<bool>     cancel  {false};
+    };
+    std::vector<Slot> slots(searchCount);
 
-        while (!primeFound.load(std::memory_order_acquire))
+    auto publish = [&](uint64_t index, const BigInt& prime)
+    {
         {
-            BigInt candidate = generateCandidate(*localPRNG);
-            if (primalityTester_->isPrime(candidate,
-                                          primalityIterations_,
-                                          *localPRNG))
+            std::lock_guard<std::mutex> lock(resultMutex);
+            if (index >= bestIndex.load()) return;
+            bestIndex.store(index);
+            primeResult = prime;
+        }
+        for (auto& other : slots)
+            if (other.current.load() > index) other.cancel.store(true);
+    };
+
+    auto search = [&](unsigned slotIndex, unsigned workerIndex)
+    {
+        SearchState& state = workerStates_[workerIndex];
+        Slot& slot = slots[slotIndex];
+        const CancellationToken cancel(slot.cancel);
+        std::vector<std::pair<uint64_t, BigInt>> batch;
+
+        try {
+            while (true)
             {
-                if (!primeFound.exchange(true))
-                    firstPrimePromise.set_value(candidate);
-                break;
+                batch.clear();
+                {
+                    std::lock_guard<std::mutex> lock(streamMutex);
+                    for (unsigned k = 0; k < batchSize; ++k)
+                    {
+                        if (aborted.load() || cursor.nextIndex > bestIndex.load()) break;
+                        BigInt candidate;
+                        const uint64_t index = nextCandidate(*prng_, cursor, candidate);
+                        batch.emplace_back(index, std::move(candidate));
+                    }
+                }
+                if (batch.empty()) return;
+
+                for (auto& [index, candidate] : batch)
+                {
+                    /* Publica o índice antes de reler bestIndex: um primo menor
+                       achado em paralelo ou é visto aqui ou nos cancela */
+                    slot.cancel.store(false);
+                    slot.current.store(index);
+                    if (aborted.load() || index > bestIndex.load()) break;
+
+                    DeferredSeedPRNG witnessPRNG(*state.prng, witnessSeed(seed, index));
+                    if (passesTests(candidate, witnessPRNG, cancel) &&
+                        !slot.cancel.load())
+                        publish(index, candidate);
+                }
+                slot.current.store(NO_INDEX);
             }
+        } catch (...) {
+            aborted.store(true);
+            for (auto& other : slots) other.cancel.store(true);
+            throw;
         }
     };
 
-    std::vector<std::thread> pool;
-    for (unsigned t = 0; t < threadCount; ++t)
-        pool.emplace_back(worker, seed + t);
-
-    BigInt primeResult = firstPrimeFuture.get();
-    for (auto& th : pool) if (th.joinable()) th.join();
+    /* Todos terminam só depois de esgotar os índices < bestIndex */
+    runSearches(searchCount, search, stats);
     return primeResult;
 }
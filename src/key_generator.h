@@ -2,17 +2,38 @@
 #pragma once
 #include "prng.h"
 #include "primality_test/primality_test.h"
+#include "incremental_sieve.h"
+#include "work_stealing_pool.h"
+#include "keygen_stats.h"
 #include <boost/multiprecision/cpp_int.hpp>
 #include <memory>
+#include <functional>
 #include <future>
 #include <atomic>
+#include <vector>
 #include <cstdint> // Incluído para uint_fast32_t
 
 using BigInt = boost::multiprecision::cpp_int;
 
+/* Estratégia de escolha dos candidatos a primo */
+enum class CandidateSearch
+{
+    Random,        // candidato novo e independente a cada tentativa
+    Incremental    // start ímpar único + crivo de janela (start + 2k)
+};
+
+/* Primo gerado e o trabalho gasto nele (contadores zerados sem KEYGEN_STATS) */
+struct KeyGenerationResult
+{
+    BigInt             key;
+    KeyGenerationStats stats;
+};
+
 /* =========================================================================
    Gera chaves RSA (ou similares) encontrando números primos com N bits.
-   Suporta geração concorrente usando múltiplas threads.
+   Suporta geração concorrente usando múltiplas threads: um pool
+   persistente (próprio ou compartilhado) executa as buscas, e cada worker
+   mantém seu clone do PRNG e seu crivo entre chamadas.
    ========================================================================= */
 class KeyGenerator
 {
@@ -21,6 +42,24 @@ private:
     std::unique_ptr<PRNG> prng_;                       // PRNG “mestre”
     PrimalityTest* primalityTester_;                   // Ponteiro externo (não possui posse)
     unsigned keyBits_;                                 // Tamanho da chave em bits
+    CandidateSearch searchMode_ {CandidateSearch::Random}; // Estratégia de busca
+    bool safePrime_ {false};                           // ver setSafePrime
+    uint64_t coprimeExponent_ {0};                     // ver setCoprimeExponent
+    unsigned topBits_ {1};                             // ver setTopBits
+
+    /* Estado de busca reaproveitado entre chamadas (um por worker) */
+    struct SearchState
+    {
+        std::unique_ptr<PRNG>             prng;       // clone de prng_
+        std::unique_ptr<IncrementalSieve> sieve;      // criado sob demanda
+    };
+    unsigned threadCount_;                             // 0 ⇒ padrão do pool
+    std::shared_ptr<WorkStealingPool> pool_;           // criado na 1ª chamada concorrente
+    std::vector<SearchState> workerStates_;            // indexado pelo worker do pool
+    std::unique_ptr<IncrementalSieve> sequentialSieve_; // crivo de generateKey
+    bool deterministic_ {false};                       // ver setDeterministic
+    unsigned streamSpacingLog2_ {0};                   // ver setStreamSpacing
+    std::unique_ptr<PRNG> sequentialWitnessPrng_;       // testemunhas (modo determinístico)
 
 public:
     // Construtor principal
@@ -33,20 +72,103 @@ public:
     void setGenerator(std::unique_ptr<PRNG> newPrng);
     // Permite trocar o algoritmo de teste de primalidade
     void setTester(PrimalityTest* newTester);
+    // Seleciona a estratégia de busca de candidatos
+    void setSearchMode(CandidateSearch mode) noexcept { searchMode_ = mode; }
+    // Primos seguros p = 2q + 1 (p com keyBits bits): candidatos q saem de
+    // um crivo conjunto de q e 2q + 1 (sempre incremental, qualquer que
+    // seja o modo de busca) e passam por Fermat na base 2 nos dois antes
+    // das rodadas do teste. Vale para todos os caminhos de geração.
+    void setSafePrime(bool enabled);
+    // Rejeita, antes de qualquer teste, primos p com gcd(p - 1, e) ≠ 1
+    // (p.ex. e = 65537 de RSA): nenhum primo é descartado depois.
+    // 0 ou 1 desliga o filtro.
+    void setCoprimeExponent(uint64_t exponent) noexcept;
+    // Bits altos fixados em 1 nos candidatos: 1 (padrão) ou 2. Com 2, o
+    // produto de dois primos de k bits tem exatamente 2k bits.
+    void setTopBits(unsigned count);
+    // Número de threads do pool próprio (0 ⇒ hardware_concurrency()/2).
+    // Descarta o pool atual; o próximo generateKeyConcurrent cria outro.
+    void setThreadCount(unsigned threadCount);
+    // Usa um pool externo (compartilhável entre geradores)
+    void setThreadPool(std::shared_ptr<WorkStealingPool> pool);
+    // Modo reprodutível: os candidatos saem de um único fluxo semeado com
+    // seed  e as testemunhas do candidato i de um PRNG semeado por (seed, i);
+    // vence o primo de menor índice. generateKey e generateKeyConcurrent
+    // devolvem então o mesmo primo, com qualquer número de threads.
+    void setDeterministic(bool enabled) noexcept { deterministic_ = enabled; }
+    // Fluxos por busca em generateKeyConcurrent: 0 (padrão) semeia a busca t
+    // com  seed + t; k > 0 semeia todas com  seed  e avança a busca t em
+    // t·2^k palavras (PRNG::discard: salto de polinômio no MT, contador no
+    // ChaCha20), dando fluxos disjuntos enquanto cada um usar < 2^k palavras.
+    void setStreamSpacing(unsigned log2Steps);
 
     /* ---------- API de geração ---------- */
     // Gera chave sequencialmente (thread única)
     [[nodiscard]] BigInt generateKey(uint_fast32_t seed);
     // Gera chave usando múltiplas threads
     [[nodiscard]] BigInt generateKeyConcurrent(uint_fast32_t seed);
+    // Idem, com os contadores de trabalho agregados de todas as buscas
+    [[nodiscard]] KeyGenerationResult generateKeyWithStats(uint_fast32_t seed);
+    [[nodiscard]] KeyGenerationResult generateKeyConcurrentWithStats(uint_fast32_t seed);
+    // Vários primos numa só rodada concorrente: as buscas do pool continuam
+    // até  count  primos (na ordem em que foram achados). Em modo
+    // determinístico, uma busca reprodutível por primo (sementes seed + i).
+    [[nodiscard]] std::vector<BigInt> generateKeysConcurrent(uint_fast32_t seed, unsigned count,
+                                                             KeyGenerationStats* stats = nullptr);
+    // Busca sequencial que continua o fluxo atual do PRNG mestre (sem
+    // setSeed: semeie uma vez e chame de novo para o próximo primo) e
+    // para quando  stop  for sinalizado — devolve então false. Para
+    // produtores de fundo (PrimePool); ignora o modo determinístico.
+    [[nodiscard]] bool generateKeyFromStream(const std::atomic<bool>& stop, BigInt& key);
 
-private:
-    // Método interno para gerar um candidato a primo (ímpar, MSB set)
-    // Agora recebe o PRNG a ser usado como argumento.
-    [[nodiscard]] BigInt generateCandidate(PRNG& prng);
+    // Escreve um candidato a primo (ímpar, MSB set) em  candidate,
+    // reaproveitando os limbs dele: sem alocação em regime. No modo de
+    // primo seguro o candidato é  q  (keyBits - 1 bits).
+    void generateCandidate(PRNG& prng, BigInt& candidate) const;
 
+private:
     // Sobrecarga mantida para compatibilidade interna ou testes simples,
     // mas a versão principal agora é a que recebe PRNG&.
     // Esta versão usará o prng_ membro após semear.
     [[nodiscard]] BigInt generateCandidate(uint_fast32_t seed);
+
+    [[nodiscard]] unsigned candidateBits() const noexcept
+    { return safePrime_ ? keyBits_ - 1 : keyBits_; }
+    // (Re)cria  sieve  se faltar ou se for de outro modo (primo/primo seguro)
+    std::unique_ptr<IncrementalSieve>& sieveFor(std::unique_ptr<IncrementalSieve>& sieve) const;
+    // Testes de um candidato; no modo de primo seguro testa q e 2q + 1 e,
+    // se ambos passarem, troca  candidate  por  2q + 1
+    bool passesTests(BigInt& candidate, PRNG& witnessPRNG, const CancellationToken& cancel);
+    // Filtro de setCoprimeExponent
+    [[nodiscard]] bool coprimeToExponent(const BigInt& prime) const;
+    // Estado do worker, com o PRNG semeado para a busca  searchIndex
+    SearchState& seedSearch(unsigned workerIndex, uint_fast32_t seed, unsigned searchIndex);
+
+    // Laço de busca compartilhado por generateKey e pelos workers
+    // concorrentes; devolve false se  stop  for sinalizado antes.
+    bool searchPrime(PRNG& prng, std::unique_ptr<IncrementalSieve>& sieve,
+                     BigInt& prime, const std::atomic<bool>* stop = nullptr);
+
+    /* ---------- Modo determinístico ---------- */
+    // Posição no fluxo de candidatos (índice do próximo e crivo corrente)
+    struct CandidateCursor
+    {
+        uint64_t nextIndex    {0};
+        bool     sieveStarted {false};
+    };
+    // Próximo candidato do fluxo; devolve o índice dele
+    uint64_t nextCandidate(PRNG& stream, CandidateCursor& cursor, BigInt& candidate);
+    [[nodiscard]] BigInt generateKeyDeterministic(uint_fast32_t seed);
+    [[nodiscard]] BigInt generateKeyDeterministicConcurrent(uint_fast32_t seed,
+                                                            KeyGenerationStats& stats);
+    [[nodiscard]] BigInt generateKeyRandomConcurrent(uint_fast32_t seed,
+                                                     KeyGenerationStats& stats);
+    // Cria o pool próprio na primeira chamada concorrente
+    void ensurePool();
+    // Executa  search(t, worker)  para t < searchCount no pool e espera
+    // todas; soma em  stats  os contadores de cada busca e as esperas
+    // de partida e de junção das threads
+    void runSearches(unsigned searchCount,
+                     const std::function<void(unsigned, unsigned)>& search,
+                     KeyGenerationStats& stats);
 };
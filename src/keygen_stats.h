@@ -0,0 +1,134 @@
+// keygen_stats.h
+#pragma once
+/*──────────────────────────────────────────────────────────────
+ *  Contadores de trabalho da geração de chaves (KEYGEN_STATS).
+ *
+ *  Cada busca aponta  activeStats  (thread_local) para o seu próprio
+ *  KeyGenerationStats enquanto roda; os pontos quentes (PRNGs, divisão
+ *  por tentativa, exponenciações, rodadas de Miller–Rabin) somam ali
+ *  sem atômicos, e o KeyGenerator agrega as buscas no fim do pedido.
+ *  Compilado com KEYGEN_STATS=0 (padrão), tudo aqui vira código vazio.
+ *──────────────────────────────────────────────────────────────*/
+#ifndef KEYGEN_STATS
+#define KEYGEN_STATS 0
+#endif
+
+#include <chrono>
+#include <cstdint>
+#if KEYGEN_STATS && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#endif
+
+struct KeyGenerationStats
+{
+    static constexpr bool enabled = KEYGEN_STATS != 0;
+
+    uint64_t candidatesGenerated    {0};  // candidatos entregues ao teste
+    uint64_t trialDivisionRejects   {0};  // descartados por isCompositeByTrialDivision
+    uint64_t millerRabinRounds      {0};  // rodadas com testemunha (inclui as nativas)
+    uint64_t modExpCount            {0};  // montPow, montPowBase2, Montgomery64::pow
+    uint64_t modExpCycles           {0};  // TSC (ns fora de x86) dentro delas
+    uint64_t prngWords              {0};  // palavras de 32 bits lidas dos PRNGs
+    uint64_t threadStartNanoseconds {0};  // Σ (início da busca − submissão ao pool)
+    uint64_t threadJoinNanoseconds  {0};  // 1ª busca encerrada → todas juntadas
+    uint64_t elapsedNanoseconds     {0};  // duração do pedido
+    unsigned searches               {0};  // buscas (threads) do pedido
+
+    KeyGenerationStats& operator+=(const KeyGenerationStats& other) noexcept
+    {
+        candidatesGenerated    += other.candidatesGenerated;
+        trialDivisionRejects   += other.trialDivisionRejects;
+        millerRabinRounds      += other.millerRabinRounds;
+        modExpCount            += other.modExpCount;
+        modExpCycles           += other.modExpCycles;
+        prngWords              += other.prngWords;
+        threadStartNanoseconds += other.threadStartNanoseconds;
+        threadJoinNanoseconds  += other.threadJoinNanoseconds;
+        elapsedNanoseconds     += other.elapsedNanoseconds;
+        searches               += other.searches;
+        return *this;
+    }
+};
+
+namespace keygen_stats {
+
+#if KEYGEN_STATS
+/* Contadores da busca em curso nesta thread (nullptr fora de uma busca) */
+inline thread_local KeyGenerationStats* activeStats = nullptr;
+
+inline uint64_t readCycleCounter() noexcept
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(
+        std::chrono::steady_clock::now().time_since_epoch() / std::chrono::nanoseconds(1));
+#endif
+}
+#endif
+
+/** stats.*field += amount  na busca ativa desta thread, se houver. */
+inline void add([[maybe_unused]] uint64_t KeyGenerationStats::* field,
+                [[maybe_unused]] uint64_t amount = 1) noexcept
+{
+#if KEYGEN_STATS
+    if (KeyGenerationStats* stats = activeStats) stats->*field += amount;
+#endif
+}
+
+/** Direciona os contadores desta thread para  stats  até o fim do escopo. */
+class Scope
+{
+public:
+    explicit Scope([[maybe_unused]] KeyGenerationStats& stats) noexcept
+    {
+#if KEYGEN_STATS
+        previous_ = activeStats;
+        activeStats = &stats;
+#endif
+    }
+    ~Scope()
+    {
+#if KEYGEN_STATS
+        activeStats = previous_;
+#endif
+    }
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+#if KEYGEN_STATS
+    KeyGenerationStats* previous_;
+#endif
+};
+
+/** Conta uma exponenciação modular e os ciclos até o fim do escopo. */
+class ModExpTimer
+{
+public:
+    ModExpTimer() noexcept
+    {
+#if KEYGEN_STATS
+        if (activeStats) start_ = readCycleCounter();
+#endif
+    }
+    ~ModExpTimer()
+    {
+#if KEYGEN_STATS
+        if (KeyGenerationStats* stats = activeStats)
+        {
+            ++stats->modExpCount;
+            stats->modExpCycles += readCycleCounter() - start_;
+        }
+#endif
+    }
+    ModExpTimer(const ModExpTimer&) = delete;
+    ModExpTimer& operator=(const ModExpTimer&) = delete;
+
+private:
+#if KEYGEN_STATS
+    uint64_t start_ {0};
+#endif
+};
+
+} // namespace keygen_stats
@@ -1,22 +1,56 @@
 /*──────────────────────────────────────────────────────────────
  *  Benchmarks:
- *    • Geração de grandes primos (com múltiplas repetições e média)
+ *    • Geração de grandes primos (várias repetições, percentis)
+ *    • FixedKeyGenerator x KeyGenerator (mesmo primo, tempos lado a lado)
+ *    • Pares de chaves RSA de ponta a ponta
+ *    • Reservatório de primos em segundo plano (PrimePool)
+ *    • Vazão dos PRNGs e alocações por candidato
  *    • Divergências Miller–Rabin × Fermat em inteiros pequenos
  *    • Números de Carmichael
+ *
+ *  Sem argumentos roda tudo, como sempre. Opções (ver --help):
+ *    --prng MT,NRPRF,CHACHA   --test MR,FT,BP   --bits 128,256,...
+ *    --reps N   --time-budget S   --threads 1,2,4   --warmup N   --safe-prime
+ *    --sections prng,stream,alloc,keygen,fixed,rsa,pool,checks
+ *    --format table|json|csv   --output arquivo
+ *  Modo de fluxo (saída bruta do PRNG para baterias estatísticas):
+ *    --stream MT|NRPRF|CHACHA  --stream-bytes 1G  --stream-output arquivo
  *──────────────────────────────────────────────────────────────*/
 #include "key_generator.h"
+#include "fixed_key_generator.h"
+#include "rsa_key_pair_generator.h"
+#include "prime_pool.h"
+#include "pseudo_rng/random_bits.h"
+#include "trial_division.h"
+#include "incremental_sieve.h"
 #include "pseudo_rng/mersenne_twister.h"
 #include "pseudo_rng/naor_reingold_prf.h"
+#include "pseudo_rng/chacha20_prng.h"
+#include "pseudo_rng/prng_stream.h"
 #include "primality_test/fermat_test.h"
 #include "primality_test/miller_rabin_test.h"
+#include "primality_test/baillie_psw_test.h"
+#include "benchmark_report.h"
+#include <algorithm>
 #include <chrono>
+#include <filesystem>
+#include <fstream>
 #include <iomanip>
 #include <iostream>
 #include <random>
 #include <vector>
 #include <map>
+#include <set>
+#include <sstream>
 #include <cmath>
 #include <limits>
+#include <atomic>
+#include <csignal>
+#include <cstdlib>
+#include <new>
+#include <cstdio>
+#include <unistd.h>
+#include <thread>
 
 using BigInt = boost::multiprecision::cpp_int;
 using Clock = std::chrono::high_resolution_clock;
@@ -24,6 +58,28 @@ using Duration = std::chrono::duration<double, std::milli>;
 
 using PrngFactory = std::function<std::unique_ptr<PRNG>()>;
 
+/* Contador global de alocações: substitui o operator new do programa
+   (new[] e as versões nothrow da libstdc++ delegam para este) */
+static std::atomic<std::size_t> heapAllocationCount{0};
+
+/* O GCC 12 toma o free() abaixo por par trocado de new/delete */
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void *operator new(std::size_t size)
+{
+    heapAllocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void *memory = std::malloc(size ? size : 1))
+        return memory;
+    throw std::bad_alloc();
+}
+void operator delete(void *memory) noexcept { std::free(memory); }
+void operator delete(void *memory, std::size_t) noexcept { std::free(memory); }
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
 static PrngFactory makeFactory(const std::string &tag, uint32_t initialSeed = 0)
 {
     if (tag == "MT")
@@ -32,52 +88,39 @@ static PrngFactory makeFactory(const std::string &tag, uint32_t initialSeed = 0)
     if (tag == "NRPRF")
         return [initialSeed]
         { return std::make_unique<NaorReingoldPRF>(initialSeed); };
+    if (tag == "CHACHA")
+        return [initialSeed]
+        { return std::make_unique<ChaCha20PRNG>(initialSeed); };
     throw std::invalid_argument("Unknown PRNG tag: " + tag);
 }
 
-static BigInt generateNBitOdd(unsigned bits, PRNG &prng)
+// Escreve em  result  um inteiro ímpar de exatamente  bits  bits,
+// reaproveitando os limbs de  result  (sem alocação em regime)
+static void generateNBitOdd(unsigned bits, PRNG &prng, BigInt &result)
 {
     if (bits == 0)
-        return 0;
-    if (bits > 100000)
-        throw std::out_of_range("Bit size too large for practical generation"); // Safety limit
-
-    const unsigned numChunks = static_cast<unsigned>(std::ceil(static_cast<double>(bits) / 32.0));
-    BigInt result = 0;
-    for (unsigned i = 0; i < numChunks; ++i)
     {
-        result <<= 32;
-        result |= prng.generate();
+        result = 0;
+        return;
     }
+    if (bits > 100000)
+        throw std::out_of_range("Bit size too large for practical generation"); // Safety limit
 
-    // Mask to get exactly N bits
-    BigInt mask = (BigInt(1) << bits) - 1;
-    result &= mask;
-
-    // Ensure the number has the desired bit length (set MSB)
-    result |= (BigInt(1) << (bits - 1));
-
-    // Ensure it's odd
-    result |= 1;
-
-    return result;
+    fillRandomBits(prng, bits, result);
+    // Ensure the number has the desired bit length (set MSB) and is odd
+    boost::multiprecision::bit_set(result, bits - 1);
+    boost::multiprecision::bit_set(result, 0);
 }
 
-// Função auxiliar para gerar um primo
-static std::pair<BigInt, double>
-generatePrime(unsigned bits,
-              uint32_t seed,
-              PrimalityTest &tester,
-              const PrngFactory &factory)
+// Função auxiliar para gerar um primo (gerador reaproveitado entre repetições)
+static std::pair<KeyGenerationResult, double>
+generatePrime(KeyGenerator &generator, uint32_t seed)
 {
-    // Cria um PRNG base que será clonado pelo KeyGenerator
-    // A posse é transferida para o KeyGenerator
-    KeyGenerator generator(factory(), &tester, bits);
     auto start = Clock::now();
-    // A 'seed' é usada internamente pelo KeyGenerator para semear os clones
-    BigInt prime = generator.generateKeyConcurrent(seed);
+    // A 'seed' é usada internamente pelo KeyGenerator para semear os workers
+    KeyGenerationResult result = generator.generateKeyConcurrentWithStats(seed);
     double ms = Duration(Clock::now() - start).count();
-    return {prime, ms};
+    return {std::move(result), ms};
 }
 
 // Função auxiliar para testar primalidade
@@ -94,151 +137,946 @@ static bool testWithPRNG(const BigInt &n,
     return tester.isPrime(n, witnessIterations, *prng); // 10 iterações padrão
 }
 
+/* Configuração da execução (linha de comando) */
+struct BenchmarkOptions
+{
+    std::vector<std::string> prngs {"MT", "NRPRF", "CHACHA"};
+    std::vector<std::string> tests {"MR", "FT", "BP"};
+    std::vector<unsigned> bits;                  // vazio ⇒ tamanhos padrão de cada seção
+    int repetitions {0};                         // 0 ⇒ padrão de cada seção
+    double timeBudgetSeconds {0};                // por célula; 0 ⇒ só repetições
+    std::vector<unsigned> threadCounts {0};      // 0 ⇒ WorkStealingPool::defaultThreadCount()
+    int warmUp {0};                              // execuções descartadas por célula
+    bool safePrime {false};                      // keygen gera primos seguros
+    std::set<std::string> sections {"prng", "stream", "alloc", "keygen", "fixed", "rsa", "pool", "checks"};
+    ReportFormat format {ReportFormat::Table};
+    std::string outputPath;                      // vazio ⇒ stdout
+
+    /* Modo de fluxo: só escreve a saída bruta de streamPrng */
+    std::string streamPrng;                      // vazio ⇒ benchmarks
+    uint64_t streamBytes {0};                    // 0 ⇒ até o leitor fechar
+    std::string streamOutput;                    // vazio ⇒ stdout
+    uint32_t streamSeed {0};
+    std::size_t streamBufferBytes {PrngStreamWriter::DEFAULT_BUFFER_BYTES};
+};
+
+static void printUsage(std::ostream &out)
+{
+    out << "Uso: rng_benchmark [opções]\n"
+           "  --prng LISTA         PRNGs: MT,NRPRF,CHACHA (padrão: todos)\n"
+           "  --test LISTA         testes: MR,FT,BP (padrão: todos)\n"
+           "  --bits LISTA         tamanhos em bits (padrão: lista de cada seção)\n"
+           "  --reps N             repetições por célula (padrão: tabela por tamanho)\n"
+           "  --time-budget S      repete cada célula até S segundos (mín. 1 amostra;\n"
+           "                       com --reps, no máximo N)\n"
+           "  --threads LISTA      threads do pool, p.ex. 1,2,4 (0 = padrão)\n"
+           "  --warmup N           execuções descartadas por célula (padrão 0)\n"
+           "  --safe-prime         keygen gera primos seguros p = 2q + 1\n"
+           "  --sections LISTA     prng,stream,alloc,keygen,fixed,rsa,pool,checks (padrão: todas)\n"
+           "                       (fixed: 1024/2048/3072/4096 bits, MT/CHACHA x MR/BP)\n"
+           "                       (em rsa, --bits é o tamanho do módulo n)\n"
+           "  --format F           table | json | csv (padrão table)\n"
+           "  --output ARQUIVO     grava JSON/CSV no arquivo; as tabelas seguem no stdout\n"
+           "  --help               mostra esta ajuda\n"
+           "\nModo de fluxo (sem benchmarks; resumo no stderr):\n"
+           "  --stream PRNG        escreve a saída bruta de MT, NRPRF ou CHACHA\n"
+           "                       (palavras de 32 bits, little-endian)\n"
+           "  --stream-bytes N     quantidade, com sufixo K/M/G (0 = até o leitor fechar)\n"
+           "  --stream-output ARQ  destino (padrão: stdout)\n"
+           "  --stream-seed N      semente (padrão 0)\n"
+           "  --buffer-size N      bytes por buffer, com sufixo K/M (padrão 8M)\n";
+}
+
+static std::vector<std::string> splitList(const std::string &option, const std::string &text)
+{
+    std::vector<std::string> items;
+    std::istringstream stream(text);
+    for (std::string item; std::getline(stream, item, ',');)
+        if (!item.empty())
+            items.push_back(item);
+    if (items.empty())
+        throw std::invalid_argument(option + ": empty list");
+    return items;
+}
+
+static unsigned long parseUnsigned(const std::string &option, const std::string &text,
+                                   unsigned long maxValue)
+{
+    std::size_t used = 0;
+    unsigned long value = 0;
+    try
+    {
+        value = std::stoul(text, &used);
+    }
+    catch (const std::exception &)
+    {
+        used = 0;
+    }
+    if (used == 0 || used != text.size() || text[0] == '-' || value > maxValue)
+        throw std::invalid_argument(option + ": invalid value '" + text + "'");
+    return value;
+}
+
+// Inteiro com sufixo binário opcional: 64K, 8M, 2G
+static uint64_t parseByteCount(const std::string &option, const std::string &text)
+{
+    std::string digits = text;
+    uint64_t multiplier = 1;
+    if (!digits.empty())
+    {
+        switch (std::toupper(static_cast<unsigned char>(digits.back())))
+        {
+        case 'K': multiplier = 1ull << 10; break;
+        case 'M': multiplier = 1ull << 20; break;
+        case 'G': multiplier = 1ull << 30; break;
+        case 'T': multiplier = 1ull << 40; break;
+        default: break;
+        }
+        if (multiplier != 1)
+            digits.pop_back();
+    }
+    const uint64_t limit = std::numeric_limits<uint64_t>::max() / multiplier;
+    return parseUnsigned(option, digits, static_cast<unsigned long>(std::min<uint64_t>(
+                                             limit, std::numeric_limits<unsigned long>::max()))) *
+           multiplier;
+}
+
+static std::vector<std::string> parseTags(const std::string &option, const std::string &text,
+                                          const std::set<std::string> &known)
+{
+    std::vector<std::string> tags = splitList(option, text);
+    for (std::string &tag : tags)
+    {
+        std::transform(tag.begin(), tag.end(), tag.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+        if (tag == "BPSW")
+            tag = "BP";
+        if (!known.count(tag))
+            throw std::invalid_argument(option + ": unknown value '" + tag + "'");
+    }
+    return tags;
+}
+
+// Lança std::invalid_argument em opção desconhecida ou valor inválido;
+// devolve false se a execução deve parar (--help)
+static bool parseOptions(int argc, char **argv, BenchmarkOptions &options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string option = argv[i];
+        std::string value;
+        const std::size_t equals = option.find('=');
+        if (equals != std::string::npos)
+        {
+            value = option.substr(equals + 1);
+            option.resize(equals);
+        }
+
+        if (option == "--help" || option == "-h")
+        {
+            printUsage(std::cout);
+            return false;
+        }
+        if (option == "--safe-prime")
+        {
+            options.safePrime = true;
+            continue;
+        }
+        static const std::set<std::string> knownOptions = {
+            "--prng", "--test", "--bits", "--reps", "--time-budget", "--threads",
+            "--warmup", "--sections", "--format", "--output", "--stream", "--stream-bytes",
+            "--stream-output", "--stream-seed", "--buffer-size"};
+        if (!knownOptions.count(option))
+            throw std::invalid_argument("unknown option " + option);
+        if (equals == std::string::npos)
+        {
+            if (i + 1 >= argc)
+                throw std::invalid_argument(option + ": missing value");
+            value = argv[++i];
+        }
+
+        if (option == "--prng")
+            options.prngs = parseTags(option, value, {"MT", "NRPRF", "CHACHA"});
+        else if (option == "--test")
+            options.tests = parseTags(option, value, {"MR", "FT", "BP"});
+        else if (option == "--bits")
+        {
+            options.bits.clear();
+            for (const std::string &item : splitList(option, value))
+            {
+                const unsigned bits = static_cast<unsigned>(parseUnsigned(option, item, 100000));
+                if (bits < 16)
+                    throw std::invalid_argument(option + ": sizes below 16 bits are not supported");
+                options.bits.push_back(bits);
+            }
+        }
+        else if (option == "--reps")
+            options.repetitions = static_cast<int>(parseUnsigned(option, value, 1'000'000));
+        else if (option == "--time-budget")
+        {
+            std::size_t used = 0;
+            try
+            {
+                options.timeBudgetSeconds = std::stod(value, &used);
+            }
+            catch (const std::exception &)
+            {
+                used = 0;
+            }
+            if (used == 0 || used != value.size() || !(options.timeBudgetSeconds >= 0))
+                throw std::invalid_argument(option + ": invalid value '" + value + "'");
+        }
+        else if (option == "--threads")
+        {
+            options.threadCounts.clear();
+            for (const std::string &item : splitList(option, value))
+                options.threadCounts.push_back(static_cast<unsigned>(parseUnsigned(option, item, 1024)));
+        }
+        else if (option == "--warmup")
+            options.warmUp = static_cast<int>(parseUnsigned(option, value, 1'000'000));
+        else if (option == "--sections")
+        {
+            options.sections.clear();
+            for (const std::string &section : splitList(option, value))
+            {
+                if (section != "prng" && section != "stream" && section != "alloc" &&
+                    section != "keygen" && section != "fixed" && section != "rsa" && section != "pool" &&
+                    section != "checks")
+                    throw std::invalid_argument(option + ": unknown section '" + section + "'");
+                options.sections.insert(section);
+            }
+        }
+        else if (option == "--format")
+        {
+            if (value == "table")
+                options.format = ReportFormat::Table;
+            else if (value == "json")
+                options.format = ReportFormat::Json;
+            else if (value == "csv")
+                options.format = ReportFormat::Csv;
+            else
+                throw std::invalid_argument(option + ": expected table, json or csv");
+        }
+        else if (option == "--output")
+            options.outputPath = value;
+        else if (option == "--stream")
+            options.streamPrng = parseTags(option, value, {"MT", "NRPRF", "CHACHA"}).front();
+        else if (option == "--stream-bytes")
+            options.streamBytes = parseByteCount(option, value);
+        else if (option == "--stream-output")
+            options.streamOutput = value;
+        else if (option == "--stream-seed")
+            options.streamSeed = static_cast<uint32_t>(parseUnsigned(option, value, 0xFFFFFFFFul));
+        else // --buffer-size
+        {
+            options.streamBufferBytes = static_cast<std::size_t>(parseByteCount(option, value));
+            if (options.streamBufferBytes == 0 || options.streamBufferBytes > (1ull << 30))
+                throw std::invalid_argument(option + ": expected 1 byte to 1G");
+        }
+    }
+    return true;
+}
+
+// Amostras (ms) de uma célula: warmUp execuções descartadas e depois
+// --reps (ou defaultRepetitions) medidas; com --time-budget repete até
+// esgotar o orçamento. runOnce(rep) recebe rep < 0 no aquecimento.
+static std::vector<double> collectSamples(const BenchmarkOptions &options, int defaultRepetitions,
+                                          const std::function<double(int)> &runOnce)
+{
+    for (int rep = 0; rep < options.warmUp; ++rep)
+        runOnce(-1 - rep);
+
+    std::vector<double> samples;
+    if (options.timeBudgetSeconds > 0)
+    {
+        const std::size_t limit = options.repetitions > 0
+                                      ? static_cast<std::size_t>(options.repetitions)
+                                      : std::numeric_limits<std::size_t>::max();
+        const auto deadline = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+                                                 std::chrono::duration<double>(options.timeBudgetSeconds));
+        do
+            samples.push_back(runOnce(static_cast<int>(samples.size())));
+        while (samples.size() < limit && Clock::now() < deadline);
+    }
+    else
+    {
+        const int repetitions = options.repetitions > 0 ? options.repetitions : defaultRepetitions;
+        for (int rep = 0; rep < repetitions; ++rep)
+            samples.push_back(runOnce(rep));
+    }
+    return samples;
+}
+
 // Benchmark 1: PRNG Generation Speed
-static void runPrngGenerationBenchmark()
+static void runPrngGenerationBenchmark(const BenchmarkOptions &options, BenchmarkReport &report,
+                                       std::ostream &out)
 {
-    std::cout << "\n"
-              << std::string(60, '=') << "\n";
-    std::cout << "   BENCHMARK: PRNG GENERATION SPEED\n";
-    std::cout << "   (Time to generate 1.000 N-bit numbers)\n";
-    std::cout << std::string(60, '=') << "\n";
-
-    const std::vector<unsigned> bitSizes =
-        {40, 56, 80, 128, 168, 224, 256, 512, 1024, 2048, 4096};
+    out << "\n"
+        << std::string(60, '=') << "\n";
+    out << "   BENCHMARK: PRNG GENERATION SPEED\n";
+    out << "   (Time to generate 1.000 N-bit numbers)\n";
+    out << "   (ChaCha20: kernel " << (ChaCha20PRNG::usesAvx2() ? "AVX2 8 blocos" : "escalar") << ")\n";
+    out << "   (MT19937: twist " << (MersenneTwister::usesAvx2() ? "AVX2" : "SSE2/escalar") << ")\n";
+    out << std::string(60, '=') << "\n";
+
+    const std::vector<unsigned> bitSizes = options.bits.empty()
+        ? std::vector<unsigned>{40, 56, 80, 128, 168, 224, 256, 512, 1024, 2048, 4096}
+        : options.bits;
     const int numIntegersToGenerate = 1000;
     const int numBenchmarkReps = 10;
     const uint32_t baseSeed = 0xBEEFCAFE;
 
-    std::cout << " PRNG | Bits | Avg Time / Batch (ms)\n";
-    std::cout << "------|------|----------------------\n";
+    out << " PRNG | Bits | Mediana / Lote (ms) |  p90 (ms) |    MB/s\n";
+    out << "------|------|---------------------|-----------|--------\n";
 
-    for (const std::string &prngTag : {"MT", "NRPRF"})
+    for (const std::string &prngTag : options.prngs)
     {
-
         for (unsigned bits : bitSizes)
         {
-            double totalTime = 0.0;
             // Use a consistent factory for this size
             PrngFactory factory = makeFactory(prngTag, baseSeed + bits);
 
-            for (int rep = 0; rep < numBenchmarkReps; ++rep)
+            BigInt temp; // reaproveitado: mede o PRNG, não o alocador
+            const auto samples = collectSamples(options, numBenchmarkReps, [&](int rep)
             {
                 auto prng = factory();
-                prng->setSeed(baseSeed + bits + rep);
+                prng->setSeed(baseSeed + bits + static_cast<uint32_t>(rep));
                 auto start = Clock::now();
                 for (int i = 0; i < numIntegersToGenerate; ++i)
                 {
-                    [[maybe_unused]] volatile BigInt temp = generateNBitOdd(bits, *prng);
+                    generateNBitOdd(bits, *prng, temp);
+                    [[maybe_unused]] volatile auto lowLimb = temp.backend().limbs()[0];
                 }
-                totalTime += Duration(Clock::now() - start).count();
-            }
+                return Duration(Clock::now() - start).count();
+            });
 
-            double avgTime = totalTime / numBenchmarkReps;
+            const SampleStats stats = SampleStats::from(samples);
+            // Bytes aleatórios consumidos por lote: ceil(bits/32) palavras por número
+            double batchBytes = 4.0 * ((bits + 31) / 32) * numIntegersToGenerate;
+            double megabytesPerSecond = batchBytes / (stats.median * 1e3);
+            report.add({"prng_batch", prngTag, "", bits, 1, stats,
+                        {{"numbers_per_batch", numIntegersToGenerate}, {"mb_per_s", megabytesPerSecond}}, ""});
 
-            std::cout << std::setw(5) << prngTag << " | "
-                      << std::setw(4) << bits << " | "
-                      << std::setw(20) << std::fixed << std::setprecision(4) << avgTime << '\n';
+            out << std::setw(5) << prngTag << " | "
+                << std::setw(4) << bits << " | "
+                << std::setw(19) << std::fixed << std::setprecision(4) << stats.median << " | "
+                << std::setw(9) << stats.p90 << " | "
+                << std::setw(7) << std::setprecision(1) << megabytesPerSecond << '\n';
         }
-        std::cout << "------|------|----------------------\n";
+        out << "------|------|---------------------|-----------|--------\n";
     }
+
+    // Vazão bruta: uma chamada virtual por palavra × preenchimento em bloco
+    out << "\n   Vazão bruta (MB/s): generate() por palavra x fill() em bloco\n";
+    out << " PRNG  | generate() |   fill()\n";
+    out << "-------|------------|----------\n";
+    for (const std::string &prngTag : options.prngs)
+    {
+        const std::size_t wordCount = 1u << 22;
+        std::vector<uint32_t> words(wordCount);
+        auto prng = makeFactory(prngTag, baseSeed)();
+
+        auto start = Clock::now();
+        uint32_t sink = 0;
+        for (std::size_t i = 0; i < wordCount; ++i)
+            sink ^= static_cast<uint32_t>(prng->generate());
+        double perWordMs = Duration(Clock::now() - start).count();
+
+        start = Clock::now();
+        prng->fill(words.data(), wordCount);
+        double bulkMs = Duration(Clock::now() - start).count();
+        [[maybe_unused]] volatile uint32_t keep = sink ^ words[wordCount / 2];
+
+        const double bytes = 4.0 * wordCount;
+        report.add({"prng_generate", prngTag, "", 32, 1, SampleStats::from({perWordMs}),
+                    {{"words", static_cast<double>(wordCount)}, {"mb_per_s", bytes / (perWordMs * 1e3)}}, ""});
+        report.add({"prng_fill", prngTag, "", 32, 1, SampleStats::from({bulkMs}),
+                    {{"words", static_cast<double>(wordCount)}, {"mb_per_s", bytes / (bulkMs * 1e3)}}, ""});
+
+        out << std::setw(6) << prngTag << " | "
+            << std::setw(10) << std::fixed << std::setprecision(1) << bytes / (perWordMs * 1e3) << " | "
+            << std::setw(8) << bytes / (bulkMs * 1e3) << '\n';
+    }
+    out << "-------|------------|----------\n";
+}
+
+// Benchmark: vazão do fluxo bruto (buffers alinhados + escritora → /dev/null)
+static void runPrngStreamBenchmark(const BenchmarkOptions &options, BenchmarkReport &report,
+                                   std::ostream &out)
+{
+    out << "\n"
+        << std::string(60, '=') << "\n";
+    out << "   BENCHMARK: FLUXO BRUTO (GB/s)\n";
+    out << "   (fill() em buffers de " << (options.streamBufferBytes >> 10)
+        << " KiB; fluxo = fill() + escritora em /dev/null)\n";
+    out << std::string(60, '=') << "\n";
+
+    const uint64_t bytesPerSample = 64ull << 20;
+    const int defaultSamples = 5;
+    const uint32_t baseSeed = 0xBEEFCAFE;
+
+    std::unique_ptr<std::FILE, int (*)(std::FILE *)> sink(std::fopen("/dev/null", "wb"), &std::fclose);
+    if (!sink)
+        throw std::runtime_error("cannot open /dev/null");
+    PrngStreamWriter writer(options.streamBufferBytes);
+    std::vector<uint32_t> block(writer.bufferBytes() / sizeof(uint32_t));
+
+    out << " PRNG  | fill() GB/s | fluxo GB/s\n";
+    out << "-------|-------------|-----------\n";
+    for (const std::string &prngTag : options.prngs)
+    {
+        auto prng = makeFactory(prngTag, baseSeed)();
+
+        /* Só o gerador: mesmos bytes, sem escrita */
+        const auto fillSamples = collectSamples(options, defaultSamples, [&](int)
+        {
+            auto start = Clock::now();
+            for (uint64_t done = 0; done < bytesPerSample; done += writer.bufferBytes())
+                prng->fill(block.data(), block.size());
+            [[maybe_unused]] volatile uint32_t keep = block[block.size() / 2];
+            return Duration(Clock::now() - start).count();
+        });
+        const auto streamSamples = collectSamples(options, defaultSamples, [&](int)
+        {
+            auto start = Clock::now();
+            writer.stream(*prng, fileno(sink.get()), bytesPerSample);
+            return Duration(Clock::now() - start).count();
+        });
+
+        const SampleStats fillStats = SampleStats::from(fillSamples);
+        const SampleStats streamStats = SampleStats::from(streamSamples);
+        const double fillGigabytesPerSecond = bytesPerSample / (fillStats.median * 1e6);
+        const double streamGigabytesPerSecond = bytesPerSample / (streamStats.median * 1e6);
+        report.add({"prng_fill_block", prngTag, "", 32, 1, fillStats,
+                    {{"bytes", static_cast<double>(bytesPerSample)}, {"gb_per_s", fillGigabytesPerSecond}}, ""});
+        report.add({"prng_stream", prngTag, "", 32, 2, streamStats,
+                    {{"bytes", static_cast<double>(bytesPerSample)}, {"gb_per_s", streamGigabytesPerSecond}}, ""});
+
+        out << std::setw(6) << prngTag << " | "
+            << std::setw(11) << std::fixed << std::setprecision(2) << fillGigabytesPerSecond << " | "
+            << std::setw(9) << streamGigabytesPerSecond << '\n';
+    }
+    out << "-------|-------------|-----------\n";
 }
 
-static void runBenchmarks(const std::string &prngTag)
+// Modo de fluxo: saída bruta no stdout ou arquivo, resumo no stderr
+static int runStreamMode(const BenchmarkOptions &options)
+{
+    std::signal(SIGPIPE, SIG_IGN); // leitor fechou (| head) ⇒ EPIPE, fim normal
+
+    std::unique_ptr<std::FILE, int (*)(std::FILE *)> file(nullptr, &std::fclose);
+    int descriptor = STDOUT_FILENO;
+    if (!options.streamOutput.empty())
+    {
+        file.reset(std::fopen(options.streamOutput.c_str(), "wb"));
+        if (!file)
+            throw std::runtime_error("cannot open " + options.streamOutput);
+        descriptor = fileno(file.get());
+    }
+
+    auto prng = makeFactory(options.streamPrng, options.streamSeed)();
+    PrngStreamWriter writer(options.streamBufferBytes);
+
+    auto start = Clock::now();
+    const uint64_t written = writer.stream(*prng, descriptor, options.streamBytes);
+    const double seconds = Duration(Clock::now() - start).count() / 1e3;
+
+    std::cerr << "[stream] " << options.streamPrng << ": " << written << " bytes em "
+              << std::fixed << std::setprecision(3) << seconds << " s ("
+              << std::setprecision(2) << written / (seconds * 1e9) << " GB/s)\n";
+    return 0;
+}
+
+// Benchmark: alocações de heap por candidato em regime (após aquecimento)
+static void runCandidateAllocationBenchmark(const BenchmarkOptions &options, BenchmarkReport &report,
+                                            std::ostream &out)
+{
+    out << "\n"
+        << std::string(60, '=') << "\n";
+    out << "   BENCHMARK: ALOCAÇÕES POR CANDIDATO (regime)\n";
+    out << "   (construção + divisão por tentativa / crivo incremental)\n";
+    out << std::string(60, '=') << "\n";
+
+    const std::vector<unsigned> bitSizes = options.bits.empty()
+        ? std::vector<unsigned>{512, 1024, 2048, 4096}
+        : options.bits;
+    const int warmUpCandidates = 64;
+    const int measuredCandidates = 20'000;
+    MillerRabinTest miller;
+
+    out << " Bits | Modo        | Alocações/cand. | ns/cand.\n";
+    out << "------|-------------|-----------------|---------\n";
+    for (unsigned bits : bitSizes)
+    {
+        KeyGenerator generator(makeFactory("MT")(), &miller, bits);
+        auto prng = makeFactory("MT", bits)();
+        BigInt candidate;
+        std::size_t survivors = 0;
+
+        auto record = [&](const char *mode, std::size_t allocations, double ms)
+        {
+            const double allocationsPerCandidate = static_cast<double>(allocations) / measuredCandidates;
+            const double nsPerCandidate = ms * 1e6 / measuredCandidates;
+            report.add({std::string("candidate_") + mode, "MT", "", bits, 1, SampleStats::from({ms}),
+                        {{"candidates", measuredCandidates},
+                         {"allocations_per_candidate", allocationsPerCandidate},
+                         {"ns_per_candidate", nsPerCandidate}}, ""});
+            out << std::setw(5) << bits << " | " << std::setw(11) << mode << " | "
+                << std::setw(15) << std::fixed << std::setprecision(4) << allocationsPerCandidate << " | "
+                << std::setw(7) << std::setprecision(1) << nsPerCandidate << '\n';
+        };
+
+        /* Aleatório: candidato novo + divisão por tentativa */
+        for (int i = 0; i < warmUpCandidates; ++i)
+        {
+            generator.generateCandidate(*prng, candidate);
+            survivors += !isCompositeByTrialDivision(candidate);
+        }
+        std::size_t before = heapAllocationCount.load();
+        auto start = Clock::now();
+        for (int i = 0; i < measuredCandidates; ++i)
+        {
+            generator.generateCandidate(*prng, candidate);
+            survivors += !isCompositeByTrialDivision(candidate);
+        }
+        record("Random", heapAllocationCount.load() - before, Duration(Clock::now() - start).count());
+
+        /* Incremental: sobreviventes do crivo (novo start só quando a janela esgota) */
+        IncrementalSieve sieve(bits);
+        BigInt sieveOrigin;
+        generator.generateCandidate(*prng, sieveOrigin);
+        sieve.reset(sieveOrigin);
+        auto nextSurvivor = [&]
+        {
+            while (!sieve.nextSurvivor(candidate))
+            {
+                generator.generateCandidate(*prng, sieveOrigin);
+                sieve.reset(sieveOrigin);
+            }
+        };
+        for (int i = 0; i < warmUpCandidates; ++i)
+            nextSurvivor();
+        before = heapAllocationCount.load();
+        auto sieveStart = Clock::now();
+        for (int i = 0; i < measuredCandidates; ++i)
+            nextSurvivor();
+        record("Incremental", heapAllocationCount.load() - before, Duration(Clock::now() - sieveStart).count());
+        [[maybe_unused]] volatile std::size_t keep = survivors;
+    }
+    out << "------|-------------|-----------------|---------\n";
+}
+
+// --- Seção A: Geração de Grandes Primos (percentis por célula) ---
+static void runKeyGenerationBenchmark(const std::string &prngTag, const BenchmarkOptions &options,
+                                      BenchmarkReport &report, std::ostream &out)
 {
     PrngFactory factory = makeFactory(prngTag);
     MillerRabinTest miller;
     FermatTest fermat;
+    BailliePSWTest bailliePSW;
+    const std::map<std::string, PrimalityTest *> testers = {
+        {"MR", &miller}, {"FT", &fermat}, {"BP", &bailliePSW}};
 
     const uint32_t baseSeed = 0xA5A5A5A5u;
 
-    // --- Seção A: Geração de Grandes Primos (Modificada) ---
-
     // Mapeamento de tamanho de bits para número de repetições
     const std::map<unsigned, int> repetitionsMap = {
-        {40, 1000}, {56, 500}, {80, 200}, {128, 100}, {168, 50}, {224, 25}, {256, 15}, {512, 10}, {1024, 8}, {2048, 5}, {4096, 2}};
-    // Vetor de tamanhos de bits a testar (ordenado pelo map implicitamente, mas podemos definir explicitamente)
-    const std::vector<unsigned> bitSizes =
-        {40, 56, 80, 128, 168, 224, 256, 512, 1024, 2048, 4096};
+        {40, 1000}, {56, 500}, {80, 200}, {128, 100}, {168, 50}, {224, 25}, {256, 15}, {512, 10}, {1024, 8}, {2048, 5}, {4096, 2}, {8192, 1}, {16384, 1}};
+    // 8192 e 16384 usam o caminho Karatsuba/Toom-3 do Montgomery
+    const std::vector<unsigned> bitSizes = options.bits.empty()
+        ? std::vector<unsigned>{40, 56, 80, 128, 168, 224, 256, 512, 1024, 2048, 4096, 8192, 16384}
+        : options.bits;
 
-    std::cout << "\n=== PRNG: " << prngTag << " — Geração de Grandes Primos (Média de Repetições) ===\n";
-    if (prngTag == "NRPRF")
+    auto prefix64 = [](const BigInt &n, unsigned bits)
     {
-        std::cout << "*** Aviso: Testes com NRPRF, especialmente para bits >= 512, podem ser MUITO lentos! ***\n";
-    }
-    std::cout << " Bits | Reps | Alg | Média (ms) | Último Prefixo\n";
-    std::cout << "------|------|-----|------------|-----------------\n";
+        std::ostringstream oss;
+        unsigned shift = (bits > 64) ? bits - 64 : 0;
+        oss << std::hex << (n >> shift);
+        return "0x" + oss.str();
+    };
 
-    for (unsigned bits : bitSizes)
+    out << "\n=== PRNG: " << prngTag << " — Geração de Grandes Primos"
+        << (options.safePrime ? " Seguros" : "") << " (ms por primo) ===\n";
+    out << " Thr | Bits | Alg | Reps |    Mínimo |   Mediana |       p90 |       p99 |    Desvio | Último Prefixo\n";
+    const std::string separator =
+        "-----|------|-----|------|-----------|-----------|-----------|-----------|-----------|-----------------\n";
+    out << separator;
+
+    for (unsigned threadCount : options.threadCounts)
     {
-        int repetitions = 1; // Valor padrão caso não encontre no map
-        auto it = repetitionsMap.find(bits);
-        if (it != repetitionsMap.end())
+        // Pool único por contagem de threads: criado uma só vez
+        auto pool = std::make_shared<WorkStealingPool>(threadCount);
+
+        for (unsigned bits : bitSizes)
         {
-            repetitions = it->second;
+            int repetitions = 1; // Valor padrão caso não encontre no map
+            auto it = repetitionsMap.find(bits);
+            if (it != repetitionsMap.end())
+                repetitions = it->second;
+            else if (options.repetitions == 0 && options.timeBudgetSeconds == 0)
+                std::cerr << "Aviso: Número de repetições não definido para " << bits << " bits. Usando 1.\n";
+
+            for (std::size_t t = 0; t < options.tests.size(); ++t)
+            {
+                const std::string &testTag = options.tests[t];
+                // Um gerador por teste, reaproveitado em todas as repetições
+                KeyGenerator generator(factory(), testers.at(testTag), bits);
+                generator.setThreadPool(pool);
+                generator.setSafePrime(options.safePrime);
+
+                // Sementes distintas por repetição e por teste
+                const uint32_t seedBase = baseSeed + bits + static_cast<uint32_t>(t) * 0x10000u;
+                BigInt lastPrime = 0;
+                KeyGenerationStats work;                 // somado sobre as amostras medidas
+                const auto samples = collectSamples(options, repetitions, [&](int rep)
+                {
+                    auto [result, ms] = generatePrime(generator, seedBase + static_cast<uint32_t>(rep));
+                    lastPrime = std::move(result.key);
+                    if (rep >= 0)
+                        work += result.stats;
+                    return ms;
+                });
+
+                const SampleStats stats = SampleStats::from(samples);
+                std::vector<std::pair<std::string, double>> metrics;
+                if constexpr (KeyGenerationStats::enabled)
+                {
+                    // Médias por primo: separam o azar nas lacunas entre primos
+                    // (mais candidatos) de uma máquina lenta (mais ciclos por modexp)
+                    const double perPrime = 1.0 / static_cast<double>(samples.size());
+                    metrics = {
+                        {"candidates_per_prime", work.candidatesGenerated * perPrime},
+                        {"trial_division_rejects_per_prime", work.trialDivisionRejects * perPrime},
+                        {"mr_rounds_per_prime", work.millerRabinRounds * perPrime},
+                        {"modexp_per_prime", work.modExpCount * perPrime},
+                        {"cycles_per_modexp", work.modExpCount ? double(work.modExpCycles) / work.modExpCount : 0.0},
+                        {"prng_words_per_prime", work.prngWords * perPrime},
+                        {"thread_start_us_per_prime", work.threadStartNanoseconds * perPrime / 1e3},
+                        {"thread_join_us_per_prime", work.threadJoinNanoseconds * perPrime / 1e3},
+                    };
+                }
+                report.add({options.safePrime ? "keygen_safe_prime" : "keygen", prngTag, testTag, bits, pool->size(), stats, metrics, prefix64(lastPrime, bits)});
+
+                out << std::setw(4) << pool->size() << " | "
+                    << std::setw(4) << bits << " | "
+                    << std::setw(3) << testTag << " | "
+                    << std::setw(4) << stats.count << " | "
+                    << std::fixed << std::setprecision(2)
+                    << std::setw(9) << stats.min << " | "
+                    << std::setw(9) << stats.median << " | "
+                    << std::setw(9) << stats.p90 << " | "
+                    << std::setw(9) << stats.p99 << " | "
+                    << std::setw(9) << stats.stddev << " | "
+                    << prefix64(lastPrime, bits) << '\n';
+                if constexpr (KeyGenerationStats::enabled)
+                {
+                    out << "     por primo:";
+                    for (const auto &[name, value] : metrics)
+                        out << ' ' << name << '=' << std::setprecision(1) << value;
+                    out << '\n';
+                }
+            }
+            out << separator;
         }
-        else
+    }
+}
+
+// --- FixedKeyGenerator × KeyGenerator: mesmo primo, tempos lado a lado ---
+template <unsigned Bits, class Prng, class Tester>
+static unsigned runFixedKeyGenerationRow(const std::string &prngTag, const std::string &testTag,
+                                         const BenchmarkOptions &options, BenchmarkReport &report,
+                                         std::ostream &out)
+{
+    const uint32_t baseSeed = 0xF1CEDu;
+    const std::map<unsigned, int> repetitionsMap = {{1024, 8}, {2048, 5}, {3072, 3}, {4096, 2}};
+
+    FixedKeyGenerator<Bits, Prng, Tester> fixedGenerator;
+    Tester referenceTester;
+    KeyGenerator referenceGenerator(std::make_unique<Prng>(), &referenceTester, Bits);
+
+    // Cada repetição gera o mesmo primo pelos dois caminhos (KeyGenerator
+    // sequencial, modo Random) e confere a igualdade
+    std::vector<double> referenceSamples;
+    unsigned mismatches = 0;
+    const auto samples = collectSamples(options, repetitionsMap.at(Bits), [&](int rep)
+    {
+        const uint32_t seed = baseSeed + Bits + static_cast<uint32_t>(rep);
+        auto start = Clock::now();
+        const BigInt fixedKey(fixedGenerator.generateKey(seed));
+        const double fixedMs = Duration(Clock::now() - start).count();
+
+        start = Clock::now();
+        const BigInt referenceKey = referenceGenerator.generateKey(seed);
+        const double referenceMs = Duration(Clock::now() - start).count();
+
+        if (fixedKey != referenceKey) ++mismatches;
+        if (rep >= 0) referenceSamples.push_back(referenceMs);
+        return fixedMs;
+    });
+
+    const SampleStats stats = SampleStats::from(samples);
+    const SampleStats referenceStats = SampleStats::from(referenceSamples);
+    const double speedup = referenceStats.median / stats.median;
+    report.add({"keygen_fixed", prngTag, testTag, Bits, 1, stats,
+                {{"keygen_median_ms", referenceStats.median},
+                 {"speedup", speedup},
+                 {"mismatches", static_cast<double>(mismatches)}},
+                ""});
+
+    out << std::setw(4) << Bits << " | "
+        << std::setw(3) << testTag << " | "
+        << std::setw(4) << stats.count << " | "
+        << std::fixed << std::setprecision(2)
+        << std::setw(13) << stats.median << " | "
+        << std::setw(15) << referenceStats.median << " | "
+        << std::setw(6) << speedup << "x | "
+        << (mismatches == 0 ? "sim" : "NÃO") << '\n';
+    return mismatches;
+}
+
+template <class Prng, class Tester>
+static unsigned runFixedKeyGenerationRows(const std::string &prngTag, const std::string &testTag,
+                                          const std::vector<unsigned> &bitSizes,
+                                          const BenchmarkOptions &options, BenchmarkReport &report,
+                                          std::ostream &out)
+{
+    unsigned mismatches = 0;
+    for (unsigned bits : bitSizes)
+    {
+        switch (bits)
         {
-            std::cerr << "Aviso: Número de repetições não definido para " << bits << " bits. Usando 1.\n";
+        case 1024: mismatches += runFixedKeyGenerationRow<1024, Prng, Tester>(prngTag, testTag, options, report, out); break;
+        case 2048: mismatches += runFixedKeyGenerationRow<2048, Prng, Tester>(prngTag, testTag, options, report, out); break;
+        case 3072: mismatches += runFixedKeyGenerationRow<3072, Prng, Tester>(prngTag, testTag, options, report, out); break;
+        case 4096: mismatches += runFixedKeyGenerationRow<4096, Prng, Tester>(prngTag, testTag, options, report, out); break;
         }
+    }
+    return mismatches;
+}
 
-        double totalTimeMR = 0.0;
-        double totalTimeFT = 0.0;
-        BigInt lastPrimeMR = 0; // Para guardar o último primo gerado para o prefixo
-        BigInt lastPrimeFT = 0;
+static void runFixedKeyGenerationBenchmark(const std::string &prngTag, const BenchmarkOptions &options,
+                                           BenchmarkReport &report, std::ostream &out)
+{
+    // Só as combinações instanciadas em fixed_key_generator.cpp
+    if (prngTag != "MT" && prngTag != "CHACHA") return;
+    std::vector<unsigned> bitSizes;
+    for (unsigned bits : {1024u, 2048u, 3072u, 4096u})
+        if (options.bits.empty() ||
+            std::find(options.bits.begin(), options.bits.end(), bits) != options.bits.end())
+            bitSizes.push_back(bits);
+    if (bitSizes.empty()) return;
 
-        for (int i = 0; i < repetitions; ++i)
-        {
-            // Gera sementes diferentes para cada repetição e cada teste
-            uint32_t seedMR = baseSeed + bits + i;
-            uint32_t seedFT = baseSeed + bits + i + (repetitions * 10); // Garante sementes distintas para FT
+    out << "\n=== PRNG: " << prngTag << " — FixedKeyGenerator x KeyGenerator (ms por primo, sequencial) ===\n";
+    out << "Bits | Alg | Reps | Fixed mediana | KeyGen. mediana | Speedup | Iguais\n";
+    const std::string separator =
+        "-----|-----|------|---------------|-----------------|---------|-------\n";
+    out << separator;
+
+    unsigned mismatches = 0;
+    for (const std::string &testTag : options.tests)
+    {
+        if (prngTag == "MT" && testTag == "MR")
+            mismatches += runFixedKeyGenerationRows<MersenneTwister, MillerRabinTest>(prngTag, testTag, bitSizes, options, report, out);
+        else if (prngTag == "MT" && testTag == "BP")
+            mismatches += runFixedKeyGenerationRows<MersenneTwister, BailliePSWTest>(prngTag, testTag, bitSizes, options, report, out);
+        else if (prngTag == "CHACHA" && testTag == "MR")
+            mismatches += runFixedKeyGenerationRows<ChaCha20PRNG, MillerRabinTest>(prngTag, testTag, bitSizes, options, report, out);
+        else if (prngTag == "CHACHA" && testTag == "BP")
+            mismatches += runFixedKeyGenerationRows<ChaCha20PRNG, BailliePSWTest>(prngTag, testTag, bitSizes, options, report, out);
+    }
+    out << separator;
+
+    if (mismatches != 0)
+        throw std::runtime_error("FixedKeyGenerator diverged from KeyGenerator (" +
+                                 std::to_string(mismatches) + " primes)");
+}
 
-            auto [pMR, tMR] = generatePrime(bits, seedMR, miller, factory);
-            auto [pFT, tFT] = generatePrime(bits, seedFT, fermat, factory);
+// --- Pares de chaves RSA de ponta a ponta (p e q em paralelo, d e CRT) ---
+static void runRsaKeyPairBenchmark(const std::string &prngTag, const BenchmarkOptions &options,
+                                   BenchmarkReport &report, std::ostream &out)
+{
+    MillerRabinTest miller;
+    FermatTest fermat;
+    BailliePSWTest bailliePSW;
+    const std::map<std::string, PrimalityTest *> testers = {
+        {"MR", &miller}, {"FT", &fermat}, {"BP", &bailliePSW}};
+
+    const uint32_t baseSeed = 0x5A5A5A5Au;
+    // Bits do módulo n (cada primo tem a metade)
+    const std::map<unsigned, int> repetitionsMap = {{1024, 10}, {2048, 5}, {3072, 2}, {4096, 1}};
+    const std::vector<unsigned> modulusSizes = options.bits.empty()
+        ? std::vector<unsigned>{1024, 2048}
+        : options.bits;
 
-            totalTimeMR += tMR;
-            totalTimeFT += tFT;
+    out << "\n=== PRNG: " << prngTag << " — Pares de Chaves RSA, e = 65537 (ms por par) ===\n";
+    out << " Thr | Bits | Alg | Reps |    Mínimo |   Mediana |       p90 |       p99 |    Desvio\n";
+    const std::string separator =
+        "-----|------|-----|------|-----------|-----------|-----------|-----------|----------\n";
+    out << separator;
+
+    for (unsigned threadCount : options.threadCounts)
+    {
+        auto pool = std::make_shared<WorkStealingPool>(threadCount);
+
+        for (unsigned bits : modulusSizes)
+        {
+            if (bits % 2 != 0)
+            {
+                std::cerr << "Aviso: módulo RSA de " << bits << " bits (ímpar) ignorado.\n";
+                continue;
+            }
+            auto it = repetitionsMap.find(bits);
+            const int repetitions = (it != repetitionsMap.end()) ? it->second : 1;
 
-            // Guarda o último primo gerado em cada categoria
-            if (i == repetitions - 1)
+            for (std::size_t t = 0; t < options.tests.size(); ++t)
             {
-                lastPrimeMR = pMR;
-                lastPrimeFT = pFT;
+                const std::string &testTag = options.tests[t];
+                RsaKeyPairGenerator generator(makeFactory(prngTag)(), testers.at(testTag), bits);
+                generator.setThreadPool(pool);
+
+                const uint32_t seedBase = baseSeed + bits + static_cast<uint32_t>(t) * 0x10000u;
+                BigInt lastModulus = 0;
+                const auto samples = collectSamples(options, repetitions, [&](int rep)
+                {
+                    auto start = Clock::now();
+                    RsaKeyPair key = generator.generate(seedBase + static_cast<uint32_t>(rep));
+                    const double ms = Duration(Clock::now() - start).count();
+                    lastModulus = std::move(key.n);
+                    return ms;
+                });
+
+                const SampleStats stats = SampleStats::from(samples);
+                std::ostringstream modulusPrefix;
+                modulusPrefix << "0x" << std::hex << (lastModulus >> (bits > 64 ? bits - 64 : 0));
+                report.add({"rsa_keypair", prngTag, testTag, bits, pool->size(), stats, {},
+                            modulusPrefix.str()});
+
+                out << std::setw(4) << pool->size() << " | "
+                    << std::setw(4) << bits << " | "
+                    << std::setw(3) << testTag << " | "
+                    << std::setw(4) << stats.count << " | "
+                    << std::fixed << std::setprecision(2)
+                    << std::setw(9) << stats.min << " | "
+                    << std::setw(9) << stats.median << " | "
+                    << std::setw(9) << stats.p90 << " | "
+                    << std::setw(9) << stats.p99 << " | "
+                    << std::setw(9) << stats.stddev << '\n';
             }
+            out << separator;
         }
+    }
+}
 
-        double avgTimeMR = (repetitions > 0) ? totalTimeMR / repetitions : 0.0;
-        double avgTimeFT = (repetitions > 0) ? totalTimeFT / repetitions : 0.0;
+// --- Reservatório de primos: enchimento em segundo plano, reabertura e take ---
+static void runPrimePoolBenchmark(const std::string &prngTag, const BenchmarkOptions &options,
+                                  BenchmarkReport &report, std::ostream &out)
+{
+    MillerRabinTest miller;
+    FermatTest fermat;
+    BailliePSWTest bailliePSW;
+    const std::map<std::string, PrimalityTest *> testers = {
+        {"MR", &miller}, {"FT", &fermat}, {"BP", &bailliePSW}};
+    const std::string &testTag = options.tests.front();
+
+    // Marca alta ≥ 100: o p99 do take precisa de amostras suficientes
+    const std::size_t lowWatermark = 16, highWatermark = 128;
+    const auto fillTimeout = std::chrono::minutes(10);
+    // 128 primos de 2048 bits levam ~1 min por linha: padrão menor, --bits amplia
+    const std::vector<unsigned> bitSizes = options.bits.empty()
+        ? std::vector<unsigned>{512, 1024}
+        : options.bits;
+    const std::string storePath = (std::filesystem::temp_directory_path() /
+                                   ("rng_benchmark_" + std::to_string(::getpid()) + ".primes")).string();
 
-        auto prefix64 = [bits](const BigInt &n)
+    // take() é medido no pool reaberto, sem workers: só o pop e a leitura do registro
+    BenchmarkOptions takeOptions = options;
+    takeOptions.repetitions = 0;
+    takeOptions.timeBudgetSeconds = 0;
+    takeOptions.warmUp = 0;
+
+    out << "\n=== PRNG: " << prngTag << " — Reservatório de Primos (" << testTag
+        << ", marcas " << lowWatermark << "/" << highWatermark << ") ===\n";
+    out << " Wrk | Bits | Enchimento (ms) | Recuperados | take mediana (µs) | take p99 (µs)\n";
+    const std::string separator =
+        "-----|------|-----------------|-------------|-------------------|--------------\n";
+    out << separator;
+
+    for (unsigned threadCount : options.threadCounts)
+    {
+        const unsigned workers = threadCount ? threadCount : WorkStealingPool::defaultThreadCount();
+        for (unsigned bits : bitSizes)
         {
-            std::ostringstream oss;
-            unsigned shift = (bits > 64) ? bits - 64 : 0;
-            oss << std::hex << (n >> shift);
-            return "0x" + oss.str(); // Adiciona "0x" aqui
-        };
+            std::remove(storePath.c_str());
+            double fillMs = 0;
+            bool filled = false;
+            std::size_t produced = 0;
+            {
+                PrimePool pool(makeFactory(prngTag)(), testers.at(testTag), storePath, workers);
+                pool.addBitSize(bits, lowWatermark, highWatermark);
+                auto start = Clock::now();
+                pool.start();
+                filled = pool.waitUntilFull(fillTimeout);
+                fillMs = Duration(Clock::now() - start).count();
+                produced = pool.available(bits);
+            }
+            if (!filled)
+            {
+                // Timeout ou arquivo cheio: enchimento e take deixariam de ser comparáveis
+                std::cerr << "Aviso: reservatório de " << bits << " bits não encheu ("
+                          << produced << "/" << highWatermark << " primos em "
+                          << std::fixed << std::setprecision(0) << fillMs << " ms); linha ignorada.\n";
+                continue;
+            }
+
+            /* "Reinício": o que foi gerado volta do arquivo */
+            PrimePool reopened(makeFactory(prngTag)(), testers.at(testTag), storePath, workers);
+            reopened.addBitSize(bits, lowWatermark, highWatermark);
+            const std::size_t recovered = reopened.available(bits);
 
-        // Imprime a linha para Miller-Rabin
-        std::cout << std::setw(5) << bits << " | "
-                  << std::setw(4) << repetitions << " | MR  | "
-                  << std::setw(10) << std::fixed << std::setprecision(2) << avgTimeMR << " | "
-                  << prefix64(lastPrimeMR) << '\n';
-
-        // Imprime a linha para Fermat
-        std::cout << std::setw(5) << "" << " | "       // Espaço em branco para alinhar
-                  << std::setw(4) << "" << " | FT  | " // Espaço em branco para alinhar
-                  << std::setw(10) << std::fixed << std::setprecision(2) << avgTimeFT << " | "
-                  << prefix64(lastPrimeFT) << '\n';
-        std::cout << "------|------|-----|------------|-----------------\n"; // Separador
+            const auto samples = collectSamples(takeOptions, static_cast<int>(recovered), [&](int)
+            {
+                auto start = Clock::now();
+                std::optional<BigInt> prime = reopened.tryTake(bits);
+                const double ms = Duration(Clock::now() - start).count();
+                [[maybe_unused]] volatile bool taken = prime.has_value();
+                return ms;
+            });
+
+            const SampleStats stats = SampleStats::from(samples);
+            report.add({"prime_pool_take", prngTag, testTag, bits, workers, stats,
+                        {{"fill_ms", fillMs},
+                         {"recovered", static_cast<double>(recovered)},
+                         {"high_watermark", static_cast<double>(highWatermark)}},
+                        ""});
+
+            out << std::setw(4) << workers << " | "
+                << std::setw(4) << bits << " | "
+                << std::fixed << std::setprecision(2)
+                << std::setw(15) << fillMs << " | "
+                << std::setw(11) << recovered << " | "
+                << std::setw(17) << stats.median * 1e3 << " | "
+                << std::setw(12) << stats.p99 * 1e3 << '\n';
+        }
+        out << separator;
     }
+    std::remove(storePath.c_str());
+}
+
+// --- Seções B e C: verificações de correção (não dependem de --bits) ---
+static void runCorrectnessChecks(const std::string &prngTag, BenchmarkReport &report, std::ostream &out)
+{
+    PrngFactory factory = makeFactory(prngTag);
+    MillerRabinTest miller;
+    FermatTest fermat;
 
     // --- Seção B: Divergências em inteiros pequenos ---
     const std::vector<unsigned> smallBits{16, 24, 32, 256, 512};
     const int sampleCount = 1'000;
     std::mt19937 urbg(0xC0FFEE); // Gerador independente para amostras
 
-    std::cout << "\n=== PRNG: " << prngTag << " — Divergências MR x FT ===\n";
-    std::cout << " Bits | Amostras | Discordâncias\n";
-    std::cout << "------|----------|--------------\n";
+    out << "\n=== PRNG: " << prngTag << " — Divergências MR x FT ===\n";
+    out << " Bits | Amostras | Discordâncias\n";
+    out << "------|----------|--------------\n";
 
     for (unsigned bits : smallBits)
     {
@@ -254,20 +1092,22 @@ static void runBenchmarks(const std::string &prngTag)
                 testWithPRNG(n, fermat, factory))
                 ++mismatches;
         }
-        std::cout << std::setw(5) << bits << " | "
-                  << std::setw(8) << sampleCount << " | "
-                  << std::setw(12) << mismatches << '\n';
+        report.add({"mr_ft_divergence", prngTag, "MR/FT", bits, 1, {},
+                    {{"samples", sampleCount}, {"mismatches", mismatches}}, ""});
+        out << std::setw(5) << bits << " | "
+            << std::setw(8) << sampleCount << " | "
+            << std::setw(12) << mismatches << '\n';
     }
-    std::cout << "------|----------|--------------\n";
+    out << "------|----------|--------------\n";
 
     // --- Seção C: Carmichael ---
     const uint64_t carmichael[] = {
         561, 1105, 1729, 2465, 6601, 8911, 10585, 15841,
         29341, 41041, 46657, 52633};
 
-    std::cout << "\n=== PRNG: " << prngTag << " — Números de Carmichael ===\n";
-    std::cout << "   n   | Fermat   | MillerRabin\n";
-    std::cout << "-------|----------|------------\n";
+    out << "\n=== PRNG: " << prngTag << " — Números de Carmichael ===\n";
+    out << "   n   | Fermat   | MillerRabin\n";
+    out << "-------|----------|------------\n";
 
     for (uint64_t n64 : carmichael)
     {
@@ -275,26 +1115,98 @@ static void runBenchmarks(const std::string &prngTag)
         bool ftIsPrime = testWithPRNG(n, fermat, factory);
         bool mrIsPrime = testWithPRNG(n, miller, factory);
 
-        std::cout << std::setw(6) << n64 << " | "
-                  << std::setw(8) << (ftIsPrime ? "primo" : "composto") << " | "  // Ajustado setw
-                  << std::setw(10) << (mrIsPrime ? "primo" : "composto") << '\n'; // Ajustado setw
+        out << std::setw(6) << n64 << " | "
+            << std::setw(8) << (ftIsPrime ? "primo" : "composto") << " | "  // Ajustado setw
+            << std::setw(10) << (mrIsPrime ? "primo" : "composto") << '\n'; // Ajustado setw
     }
-    std::cout << "-------|----------|------------\n";
+    out << "-------|----------|------------\n";
+}
+
+static std::vector<std::pair<std::string, std::string>> describeEnvironment(int argc, char **argv)
+{
+    std::string commandLine;
+    for (int i = 1; i < argc; ++i)
+        commandLine += (i > 1 ? " " : "") + std::string(argv[i]);
+
+    return {
+        {"compiler", __VERSION__},
+        {"hardware_threads", std::to_string(std::thread::hardware_concurrency())},
+        {"default_pool_threads", std::to_string(WorkStealingPool::defaultThreadCount())},
+        {"mt_twist", MersenneTwister::usesAvx2() ? "avx2" : "sse2/scalar"},
+        {"chacha_kernel", ChaCha20PRNG::usesAvx2() ? "avx2" : "scalar"},
+        {"keygen_stats", KeyGenerationStats::enabled ? "on" : "off"},
+        {"arguments", commandLine},
+    };
 }
 
 // --- main ---
-int main()
+int main(int argc, char **argv)
 {
     try
     {
-        std::cout << "Starting Benchmarks...\n";
+        BenchmarkOptions options;
+        try
+        {
+            if (!parseOptions(argc, argv, options))
+                return 0;
+        }
+        catch (const std::invalid_argument &e)
+        {
+            std::cerr << "[ERROR] " << e.what() << "\n\n";
+            printUsage(std::cerr);
+            return 2;
+        }
+        if (!options.streamPrng.empty())
+            return runStreamMode(options);
 
-        runPrngGenerationBenchmark();
+        // Em JSON/CSV no stdout as tabelas são suprimidas (saída só com o relatório)
+        std::ostream discard(nullptr);
+        const bool tablesToStdout = options.format == ReportFormat::Table || !options.outputPath.empty();
+        std::ostream &out = tablesToStdout ? std::cout : discard;
 
-        runBenchmarks("MT");
-        runBenchmarks("NRPRF");
+        BenchmarkReport report;
+        report.setEnvironment(describeEnvironment(argc, argv));
 
-        std::cout << "\nBenchmarks Completetada.\n";
+        out << "Starting Benchmarks...\n";
+
+        if (options.sections.count("prng"))
+            runPrngGenerationBenchmark(options, report, out);
+        if (options.sections.count("stream"))
+            runPrngStreamBenchmark(options, report, out);
+        if (options.sections.count("alloc"))
+            runCandidateAllocationBenchmark(options, report, out);
+
+        for (const std::string &prngTag : options.prngs)
+        {
+            if (options.sections.count("keygen"))
+                runKeyGenerationBenchmark(prngTag, options, report, out);
+            if (options.sections.count("fixed"))
+                runFixedKeyGenerationBenchmark(prngTag, options, report, out);
+            if (options.sections.count("rsa"))
+                runRsaKeyPairBenchmark(prngTag, options, report, out);
+            if (options.sections.count("pool"))
+                runPrimePoolBenchmark(prngTag, options, report, out);
+            if (options.sections.count("checks"))
+                runCorrectnessChecks(prngTag, report, out);
+        }
+
+        out << "\nBenchmarks Completetada.\n";
+
+        if (options.format != ReportFormat::Table)
+        {
+            std::ofstream file;
+            if (!options.outputPath.empty())
+            {
+                file.open(options.outputPath);
+                if (!file)
+                    throw std::runtime_error("cannot open " + options.outputPath);
+            }
+            std::ostream &destination = options.outputPath.empty() ? std::cout : file;
+            if (options.format == ReportFormat::Json)
+                report.writeJson(destination);
+            else
+                report.writeCsv(destination);
+        }
     }
     catch (const std::exception &e)
     {
@@ -307,4 +1219,4 @@ int main()
         return 1;
     }
     return 0;
-}
\ No newline at end of file
+}
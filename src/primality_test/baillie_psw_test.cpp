@@ -0,0 +1,183 @@
+/*──────────────────────────────────────────────────────────────
+ *  Teste de Baillie–PSW
+ *
+ *  1. Divisão por tentativa (primos pequenos).
+ *  2. Miller–Rabin forte na base 2.
+ *  3. Lucas forte com (P, Q) = (1, (1 - D)/4), onde D é o primeiro
+ *     de 5, -7, 9, -11, 13, … com  (D / n) = -1  (Selfridge).
+ *     Com  n + 1 = d · 2^s:
+ *        U_d ≡ 0   ou   V_{d·2^r} ≡ 0  para algum 0 ≤ r < s
+ *     ⇒ provável primo.
+ *
+ *  Sequências de Lucas (passo duplo e passo +1):
+ *     U₂ₖ = Uₖ·Vₖ        V₂ₖ = Vₖ² - 2Qᵏ
+ *     Uₖ₊₁ = (P·Uₖ + Vₖ)/2     Vₖ₊₁ = (D·Uₖ + P·Vₖ)/2
+ *──────────────────────────────────────────────────────────────*/
+#include "primality_test/baillie_psw_test.h"
+#include "primality_test/montgomery.h"
+#include "primality_test/native64.h"
+#include "trial_division.h"
+#include <algorithm>
+
+using BigInt = boost::multiprecision::cpp_int;
+
+int BailliePSWTest::jacobiSymbol(long long a, const BigInt& n)
+{
+    int result = 1;
+
+    /* (-1 / n) = (-1)^((n-1)/2) */
+    const unsigned nMod8 = static_cast<unsigned>(n & 7u);
+    if (a < 0)
+    {
+        a = -a;
+        if (nMod8 % 4 == 3) result = -result;
+    }
+
+    /* (2 / n) = (-1)^((n²-1)/8) */
+    uint64_t numerator = static_cast<uint64_t>(a);
+    while (numerator && (numerator & 1u) == 0)
+    {
+        numerator >>= 1;
+        if (nMod8 == 3 || nMod8 == 5) result = -result;
+    }
+    if (numerator == 0) return 0;
+    if (numerator == 1) return result;
+
+    /* Reciprocidade quadrática: reduz n módulo o numerador (nativo) */
+    if (numerator % 4 == 3 && nMod8 % 4 == 3) result = -result;
+    uint64_t x = static_cast<uint64_t>(n % numerator);
+    uint64_t y = numerator;
+
+    while (x != 0)
+    {
+        while ((x & 1u) == 0)
+        {
+            x >>= 1;
+            if (y % 8 == 3 || y % 8 == 5) result = -result;
+        }
+        std::swap(x, y);
+        if (x % 4 == 3 && y % 4 == 3) result = -result;
+        x %= y;
+    }
+    return (y == 1) ? result : 0;
+}
+
+bool BailliePSWTest::isPrime(const BigInt& modulusUnderTest,
+                             int /*witnessIterations*/,
+                             PRNG& /*randomGenerator*/,
+                             const CancellationToken& cancel)
+{
+    if (modulusUnderTest <= 1) return false;
+    if (modulusUnderTest == 2 || modulusUnderTest == 3) return true;
+    if ((modulusUnderTest & 1) == 0) return false;
+
+    if (isCompositeByTrialDivision(modulusUnderTest))
+        return false;
+    /* Sem divisor ≤ 997 e n < 1009² ⇒ primo */
+    if (modulusUnderTest < 1009u * 1009u)
+        return true;
+    /* n < 2⁶⁴: Miller–Rabin determinístico já é exato */
+    if (boost::multiprecision::msb(modulusUnderTest) < 64)
+        return isPrimeDeterministic64(static_cast<uint64_t>(modulusUnderTest));
+
+    /* Seleção de Selfridge: D = 5, -7, 9, -11, … */
+    long long discriminant = 5;
+    while (true)
+    {
+        const int symbol = jacobiSymbol(discriminant, modulusUnderTest);
+        if (symbol == -1) break;
+        if (symbol == 0) return false;            // |D| < n compartilha fator com n
+        /* Quadrados perfeitos nunca dão -1: checar antes de seguir buscando */
+        if (discriminant == 13)
+        {
+            const BigInt root = boost::multiprecision::sqrt(modulusUnderTest);
+            if (root * root == modulusUnderTest) return false;
+        }
+        discriminant = (discriminant > 0) ? -(discriminant + 2) : -discriminant + 2;
+    }
+    const long long parameterQ = (1 - discriminant) / 4;
+
+    /* n - 1 = d₂ · 2^s₂  (Miller–Rabin)    n + 1 = dL · 2^sL  (Lucas) */
+    BigInt oddComponent;
+    unsigned powerOfTwoExponent;
+    decompose(modulusUnderTest - 1, powerOfTwoExponent, oddComponent);
+
+    BigInt lucasOdd;
+    unsigned lucasPowerOfTwo;
+    decompose(modulusUnderTest + 1, lucasPowerOfTwo, lucasOdd);
+
+    auto reduced = [&modulusUnderTest](long long value) {
+        BigInt r = BigInt(value) % modulusUnderTest;
+        if (r < 0) r += modulusUnderTest;
+        return r;
+    };
+
+    return withMontgomeryContext(modulusUnderTest, [&](const auto& ctx)
+    {
+        using Number = typename std::decay_t<decltype(ctx)>::Number;
+        auto isZero = [](const Number& x) {
+            return std::all_of(x.begin(), x.end(), [](uint64_t limb) { return limb == 0; });
+        };
+
+        /* ---------- Miller–Rabin forte, base 2 ---------- */
+        Number two;
+        ctx.modAdd(two, ctx.one(), ctx.one());
+        Number power;
+        ctx.montPow(power, two, ctx.load(oddComponent), &cancel);
+        if (cancel.isCancelled()) return false;
+        if (power != ctx.one() && power != ctx.minusOne())
+        {
+            bool hitMinusOne = false;
+            for (unsigned j = 1; j < powerOfTwoExponent && !hitMinusOne; ++j)
+            {
+                ctx.montSqr(power, power);
+                if (power == ctx.one()) return false;
+                hitMinusOne = (power == ctx.minusOne());
+            }
+            if (!hitMinusOne) return false;
+        }
+
+        /* ---------- Lucas forte (P = 1) ---------- */
+        const Number montD = ctx.toMontgomery(reduced(discriminant));
+        const Number montQ = ctx.toMontgomery(reduced(parameterQ));
+
+        Number lucasU = ctx.one();                    // U₁ = 1
+        Number lucasV = ctx.one();                    // V₁ = P = 1
+        Number powerQ = montQ;                        // Q¹
+        Number scratch, twiceQk;
+
+        for (int bit = static_cast<int>(boost::multiprecision::msb(lucasOdd)) - 1;
+             bit >= 0; --bit)
+        {
+            if (cancel.isCancelled()) return false;
+            /* k → 2k */
+            ctx.montMul(lucasU, lucasU, lucasV);
+            ctx.modAdd(twiceQk, powerQ, powerQ);
+            ctx.montSqr(lucasV, lucasV);
+            ctx.modSub(lucasV, lucasV, twiceQk);
+            ctx.montSqr(powerQ, powerQ);
+
+            /* k → k + 1 */
+            if (boost::multiprecision::bit_test(lucasOdd, static_cast<unsigned>(bit)))
+            {
+                ctx.montMul(scratch, montD, lucasU);          // D·U
+                ctx.modAdd(scratch, scratch, lucasV);         // D·U + V
+                ctx.modAdd(lucasU, lucasU, lucasV);           // U + V
+                ctx.modHalve(lucasU, lucasU);
+                ctx.modHalve(lucasV, scratch);
+                ctx.montMul(powerQ, powerQ, montQ);
+            }
+        }
+
+        if (isZero(lucasU) || isZero(lucasV)) return true;
+        for (unsigned r = 1; r < lucasPowerOfTwo; ++r)
+        {
+            ctx.modAdd(twiceQk, powerQ, powerQ);
+            ctx.montSqr(lucasV, lucasV);
+            ctx.modSub(lucasV, lucasV, twiceQk);
+            if (isZero(lucasV)) return true;
+            ctx.montSqr(powerQ, powerQ);
+        }
+        return false;
+    });
+}
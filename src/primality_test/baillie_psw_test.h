@@ -0,0 +1,24 @@
+#pragma once
+#include "primality_test.h"
+#include "prng.h"
+
+/* =========================================================================
+   Teste de Baillie–PSW
+   -------------------------------------------------------------------------
+   Miller–Rabin forte na base 2 seguido de um teste forte de Lucas com
+   parâmetros de Selfridge (método A). Determinístico: não há
+   contra-exemplo conhecido, então  iterations  e o PRNG são ignorados.
+   ========================================================================= */
+class BailliePSWTest final : public PrimalityTest
+{
+public:
+    BailliePSWTest() = default;
+    ~BailliePSWTest() override = default;
+
+    [[nodiscard]] bool isPrime(
+        const BigInt& n, int iterations, PRNG& prng,
+        const CancellationToken& cancel = CancellationToken{}) override;
+
+    /** Símbolo de Jacobi (a / n) para n ímpar positivo. */
+    [[nodiscard]] static int jacobiSymbol(long long a, const BigInt& n);
+};
@@ -0,0 +1,87 @@
+#pragma once
+/*──────────────────────────────────────────────────────────────
+ *  Fermat na base 2  –  2^(n-1) ≡ 1 (mod n)?
+ *
+ *  Na exponenciação da esquerda para a direita, multiplicar pela
+ *  base 2 é dobrar: modAdd(x, x), um deslocamento e uma subtração
+ *  condicional, no lugar de um montMul. Sobra um quadrado por bit.
+ *  Quase todo composto que sobrevive à divisão por tentativa falha
+ *  aqui, por isso o teste serve de filtro antes de rodadas caras.
+ *──────────────────────────────────────────────────────────────*/
+#include "montgomery.h"
+#include "native64.h"
+#include "cancellation_token.h"
+#include <boost/multiprecision/cpp_int.hpp>
+#include <cstdint>
+
+using BigInt = boost::multiprecision::cpp_int;
+
+/**
+ * out = 2^exponent  no domínio de Montgomery de  ctx  (MontgomeryContext
+ * ou LargeMontgomeryContext). Com  cancel  sinalizado, retorna cedo
+ * (out sem significado).
+ */
+template <class Context>
+void montPowBase2(const Context& ctx, typename Context::Number& out,
+                  const typename Context::Number& exponent,
+                  const CancellationToken* cancel = nullptr)
+{
+    keygen_stats::ModExpTimer modExpTimer;
+    int topBit = -1;
+    for (std::size_t limb = exponent.size(); limb-- > 0 && topBit < 0;)
+        if (exponent[limb])
+            topBit = static_cast<int>(limb * 64) + 63 - __builtin_clzll(exponent[limb]);
+
+    out = ctx.one();
+    if (topBit < 0) return;
+    ctx.modAdd(out, out, out);                           // bit mais alto: 2·R
+
+    for (int i = topBit - 1; i >= 0; --i)
+    {
+        if (cancel && i % 64 == 0 && cancel->isCancelled()) return;
+        ctx.montSqr(out, out);
+        if ((exponent[i / 64] >> (i % 64)) & 1u)
+            ctx.modAdd(out, out, out);                   // ·2
+    }
+}
+
+/** 2^(n-1) ≡ 1 (mod n)  para n ímpar < 2⁶⁴, em aritmética nativa. */
+[[nodiscard]] inline bool isBase2FermatProbablePrime64(uint64_t n) noexcept
+{
+    if (n < 5) return n == 2 || n == 3;
+    if ((n & 1) == 0) return false;
+
+    const Montgomery64 ctx(n);
+    const uint64_t exponent = n - 1;
+    keygen_stats::ModExpTimer modExpTimer;
+    uint64_t result = ctx.addMod(ctx.one(), ctx.one());
+    for (int i = 62 - __builtin_clzll(exponent); i >= 0; --i)
+    {
+        result = ctx.mul(result, result);
+        if ((exponent >> i) & 1u) result = ctx.addMod(result, result);
+    }
+    return result == ctx.one();
+}
+
+/**
+ * Filtro de Fermat na base 2: false ⇒ n certamente composto; true ⇒
+ * primo ou pseudoprimo de Fermat na base 2. Com  cancel  sinalizado,
+ * devolve false.
+ */
+[[nodiscard]] inline bool isBase2FermatProbablePrime(
+    const BigInt& n, const CancellationToken& cancel = CancellationToken{})
+{
+    if (n < 5) return n == 2 || n == 3;
+    if (!boost::multiprecision::bit_test(n, 0)) return false;
+    if (boost::multiprecision::msb(n) < 64)
+        return isBase2FermatProbablePrime64(static_cast<uint64_t>(n));
+
+    return withMontgomeryContext(n, [&](const auto& ctx)
+    {
+        using Number = typename std::decay_t<decltype(ctx)>::Number;
+        const Number exponent = ctx.load(n - 1);
+        Number power;
+        montPowBase2(ctx, power, exponent, &cancel);
+        return !cancel.isCancelled() && power == ctx.one();
+    });
+}
@@ -0,0 +1,27 @@
+#pragma once
+/*──────────────────────────────────────────────────────────────
+ *  CancellationToken  –  pedido cooperativo de interrupção.
+ *
+ *  Observa (sem posse) uma flag atômica do chamador. Os testes de
+ *  primalidade consultam o token entre rodadas e dentro das
+ *  exponenciações longas; quando cancelado, o resultado devolvido
+ *  não tem significado e deve ser descartado.
+ *──────────────────────────────────────────────────────────────*/
+#include <atomic>
+
+class CancellationToken
+{
+public:
+    /** Token que nunca é cancelado. */
+    constexpr CancellationToken() noexcept = default;
+    explicit constexpr CancellationToken(const std::atomic<bool>& flag) noexcept
+        : flag_(&flag) {}
+
+    [[nodiscard]] bool isCancelled() const noexcept
+    {
+        return flag_ && flag_->load(std::memory_order_relaxed);
+    }
+
+private:
+    const std::atomic<bool>* flag_ {nullptr};
+};
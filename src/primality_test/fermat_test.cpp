@@ -7,44 +7,76 @@
  *    • Calcular           a^(n-1) mod n
  *    • Resultado ≠ 1  ⇒  n é composto
  *    • Repetir k vezes  ⇒  “provavelmente primo”
- *  Atenção: números de Carmichael passam para QUALQUER witness.
+ *  Atenção: números de Carmichael passam para QUALQUER witness
+ *  coprima com n — e as witnesses são sempre coprimas (redraw até
+ *  gcd(a, n) = 1; sem divisão por tentativa antes). É de propósito:
+ *  a demonstração MR × Fermat depende de Fermat aceitá-los.
  *──────────────────────────────────────────────────────────────*/
 #include "primality_test/fermat_test.h"
-#include <boost/multiprecision/number.hpp>
+#include "primality_test/montgomery.h"
+#include "primality_test/native64.h"
+#include "primality_test/base2_fermat.h"
+#include <numeric>
+#include <boost/multiprecision/cpp_int.hpp>
 
 using boost::multiprecision::cpp_int;
 using BigInt = cpp_int;
 
 bool FermatTest::isPrime(const BigInt& modulusUnderTest,
                          int witnessIterations,
-                         PRNG& randomGenerator)
+                         PRNG& randomGenerator,
+                         const CancellationToken& cancel)
 {
     /* Casos triviais */
     if (modulusUnderTest <= 1)            return false;
     if (modulusUnderTest <= 3)            return true;
     if ((modulusUnderTest & 1) == 0)      return false;         // par > 2
 
-    const BigInt exponent = modulusUnderTest - 1;               // n-1
+    if (base2Only_)
+        return isBase2FermatProbablePrime(modulusUnderTest, cancel);
 
-    for (int iteration = 0; iteration < witnessIterations; ++iteration)
+    /* n < 2⁶⁴: mesmas rodadas aleatórias, em aritmética nativa */
+    if (boost::multiprecision::msb(modulusUnderTest) < 64)
     {
-        //const BigInt candidateWitness =
-        //    generateWitness(modulusUnderTest, randomGenerator);
-        BigInt candidateWitness;
-        BigInt g;
-        do {
-            candidateWitness = generateWitness(modulusUnderTest, randomGenerator);
-            g = boost::math::gcd(candidateWitness, modulusUnderTest);
-        } while (g != 1);
-
-        /* a^(n-1) mod n */
-        const BigInt modExpResult =
-            boost::multiprecision::powm(candidateWitness,
-                                        exponent,
-                                        modulusUnderTest);
-
-        if (modExpResult != 1)                                   // Falhou
-            return false;
+        const uint64_t modulus64 = static_cast<uint64_t>(modulusUnderTest);
+        const Montgomery64 ctx(modulus64);
+        for (int iteration = 0; iteration < witnessIterations; ++iteration)
+        {
+            if (cancel.isCancelled()) return false;
+            /* Base fixa com fator comum também é trocada por uma sorteada */
+            uint64_t candidateWitness = nextWitness(modulus64, iteration, randomGenerator);
+            while (std::gcd(candidateWitness, modulus64) != 1)
+                candidateWitness = generateWitness(modulus64, randomGenerator);
+            if (ctx.pow(ctx.toMontgomery(candidateWitness), modulus64 - 1) != ctx.one())
+                return false;
+        }
+        return true;
     }
-    return true;                                                 // Provável primo
+
+    const BigInt exponent = modulusUnderTest - 1;               // n-1
+
+    /* Rodadas no domínio de Montgomery (largura fixa até 4096 bits,
+       Karatsuba/Toom-3 acima disso) */
+    return withMontgomeryContext(modulusUnderTest, [&](const auto& ctx)
+    {
+        using Number = typename std::decay_t<decltype(ctx)>::Number;
+        const Number exponentLimbs = ctx.load(exponent);
+        Number modExpResult;
+        BigInt candidateWitness;                        // limbs reaproveitados
+
+        for (int iteration = 0; iteration < witnessIterations; ++iteration)
+        {
+            if (cancel.isCancelled()) return false;
+            nextWitness(modulusUnderTest, iteration, randomGenerator, candidateWitness);
+            while (boost::multiprecision::gcd(candidateWitness, modulusUnderTest) != 1)
+                generateWitness(modulusUnderTest, randomGenerator, candidateWitness);
+
+            /* a^(n-1) mod n  (1 no domínio de Montgomery é R mod n) */
+            ctx.montPow(modExpResult, ctx.toMontgomery(candidateWitness),
+                        exponentLimbs, &cancel);
+            if (cancel.isCancelled() || modExpResult != ctx.one())
+                return false;
+        }
+        return true;
+    });
 }
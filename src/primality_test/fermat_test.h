@@ -5,13 +5,18 @@
 class FermatTest final : public PrimalityTest
 {
 private:
-    // Gera testemunha a tal que 2 ≤ a ≤ n-2
+    bool base2Only_ {false};
 
 public:
     FermatTest() = default;
     ~FermatTest() override = default;
 
+    // Uma única rodada na base 2 com o kernel de dobras (base2_fermat.h);
+    // iterations  e o PRNG são ignorados.
+    void setBase2Only(bool enabled) noexcept { base2Only_ = enabled; }
+
     [[nodiscard]] bool isPrime(
-        const BigInt& n, int iterations, PRNG& prng) override;
+        const BigInt& n, int iterations, PRNG& prng,
+        const CancellationToken& cancel = CancellationToken{}) override;
 };
 
@@ -0,0 +1,567 @@
+/*──────────────────────────────────────────────────────────────
+ *  Multiplicação subquadrática + REDC para operandos grandes.
+ *
+ *  Karatsuba (forma subtrativa):
+ *      a·b = z₂·B²ʰ + (z₀ + z₂ - (a₀-a₁)(b₀-b₁))·Bʰ + z₀
+ *
+ *  Toom-3 (pontos 0, 1, -1, -2, ∞ — sequência de Bodrato):
+ *      r₃ = (v₋₂ - v₁)/3      r₁ = (v₁ - v₋₁)/2      r₂ = v₋₁ - v₀
+ *      r₃ = (r₂ - r₃)/2 + 2v∞  r₂ = r₂ + r₁ - v∞      r₁ = r₁ - r₃
+ *──────────────────────────────────────────────────────────────*/
+#include "large_montgomery.h"
+#include "montgomery.h"
+#include <algorithm>
+#include <stdexcept>
+
+using namespace montgomery_detail;
+
+namespace {
+
+/* ---------------- Primitivas sobre limbs ------------------------------ */
+
+/* r[0..n) = a + b ; devolve carry */
+uint64_t addN(uint64_t* r, const uint64_t* a, const uint64_t* b, std::size_t n) noexcept
+{
+    uint64_t carry = 0;
+    for (std::size_t i = 0; i < n; ++i) r[i] = addCarry(a[i], b[i], carry);
+    return carry;
+}
+
+/* r[0..n) = a - b ; devolve borrow */
+uint64_t subN(uint64_t* r, const uint64_t* a, const uint64_t* b, std::size_t n) noexcept
+{
+    uint64_t borrow = 0;
+    for (std::size_t i = 0; i < n; ++i) r[i] = subBorrow(a[i], b[i], borrow);
+    return borrow;
+}
+
+/* Soma  carry  em r[0..n) ; devolve o carry que sobrar */
+uint64_t addCarryInto(uint64_t* r, std::size_t n, uint64_t carry) noexcept
+{
+    for (std::size_t i = 0; i < n && carry; ++i)
+    {
+        r[i] += carry;
+        carry = (r[i] < carry);
+    }
+    return carry;
+}
+
+/* r[0..na) += a[0..na), propagando até r[0..nr) */
+void addInto(uint64_t* r, std::size_t nr, const uint64_t* a, std::size_t na) noexcept
+{
+    uint64_t carry = 0;
+    for (std::size_t i = 0; i < na; ++i) r[i] = addCarry(r[i], a[i], carry);
+    addCarryInto(r + na, nr - na, carry);
+}
+
+int compareN(const uint64_t* a, const uint64_t* b, std::size_t n) noexcept
+{
+    for (std::size_t i = n; i-- > 0;)
+        if (a[i] != b[i]) return a[i] < b[i] ? -1 : 1;
+    return 0;
+}
+
+/* r[0..n) = |a[0..n) - b[0..nb)| (nb ≤ n) ; true se a < b */
+bool absoluteDifference(uint64_t* r, const uint64_t* a, std::size_t n,
+                        const uint64_t* b, std::size_t nb) noexcept
+{
+    bool aHasHighLimbs = false;
+    for (std::size_t i = nb; i < n && !aHasHighLimbs; ++i) aHasHighLimbs = (a[i] != 0);
+    const bool aIsSmaller = !aHasHighLimbs && compareN(a, b, nb) < 0;
+
+    const uint64_t* larger  = aIsSmaller ? b : a;
+    const uint64_t* smaller = aIsSmaller ? a : b;
+    uint64_t borrow = 0;
+    for (std::size_t i = 0; i < nb; ++i) r[i] = subBorrow(larger[i], smaller[i], borrow);
+    for (std::size_t i = nb; i < n; ++i) r[i] = subBorrow(a[i], 0, borrow);   // só a é longo
+    return aIsSmaller;
+}
+
+/* ---------------- Produto escolar ------------------------------------- */
+
+void multiplyBasecase(uint64_t* r, const uint64_t* a, const uint64_t* b, std::size_t n) noexcept
+{
+    std::fill(r, r + 2 * n, 0);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        uint64_t carry = 0;
+        for (std::size_t j = 0; j < n; ++j)
+            r[i + j] = mulAdd(a[j], b[i], r[i + j], carry, carry);
+        r[i + n] = carry;
+    }
+}
+
+void squareBasecase(uint64_t* r, const uint64_t* a, std::size_t n) noexcept
+{
+    std::fill(r, r + 2 * n, 0);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        uint64_t carry = 0;
+        for (std::size_t j = i + 1; j < n; ++j)
+            r[i + j] = mulAdd(a[i], a[j], r[i + j], carry, carry);
+        r[i + n] = carry;
+    }
+    uint64_t shifted = 0;
+    for (std::size_t k = 0; k < 2 * n; ++k)
+    {
+        const uint64_t next = r[k] >> 63;
+        r[k] = (r[k] << 1) | shifted;
+        shifted = next;
+    }
+    uint64_t carry = 0;
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        uint64_t hi;
+        const uint64_t lo = mulAdd(a[i], a[i], 0, 0, hi);
+        r[2 * i]     = addCarry(r[2 * i], lo, carry);
+        r[2 * i + 1] = addCarry(r[2 * i + 1], hi, carry);
+    }
+}
+
+/* ---------------- Karatsuba ------------------------------------------- */
+
+void karatsuba(uint64_t* r, const uint64_t* a, const uint64_t* b,
+               std::size_t n, uint64_t* scratch)
+{
+    const bool square = (a == b);
+    const std::size_t low  = (n + 1) / 2;
+    const std::size_t high = n - low;
+
+    uint64_t* diffA  = scratch;
+    uint64_t* diffB  = scratch + low;
+    uint64_t* middle = scratch + 2 * low;          // 2·low limbs
+    uint64_t* next   = scratch + 4 * low;
+
+    const bool negA = absoluteDifference(diffA, a, low, a + low, high);
+    const bool negB = square ? negA
+                             : absoluteDifference(diffB, b, low, b + low, high);
+
+    large_multiply::multiply(r, a, square ? a : b, low, next);                      // z₀
+    large_multiply::multiply(r + 2 * low, a + low, square ? a + low : b + low,
+                             high, next);                                           // z₂
+    large_multiply::multiply(middle, diffA, square ? diffA : diffB, low, next);     // |zm|
+
+    /* t = z₀ + z₂ ∓ zm   (2·low + 1 limbs, sempre ≥ 0) */
+    uint64_t* t = next;
+    std::copy(r, r + 2 * low, t);
+    t[2 * low] = 0;
+    addInto(t, 2 * low + 1, r + 2 * low, 2 * high);
+    if (negA != negB) addInto(t, 2 * low + 1, middle, 2 * low);
+    else
+    {
+        const uint64_t borrow = subN(t, t, middle, 2 * low);
+        t[2 * low] -= borrow;
+    }
+    addInto(r + low, 2 * n - low, t, std::min(2 * low + 1, 2 * n - low));
+}
+
+/* ---------------- Toom-3 ---------------------------------------------- */
+
+/* Vista com sinal, de largura fixa, sobre limbs do scratch (sem posse) */
+struct SignedLimbs
+{
+    uint64_t*   magnitude;
+    std::size_t width;
+    bool        negative {false};
+
+    SignedLimbs(uint64_t* limbs, std::size_t limbCount) noexcept
+        : magnitude(limbs), width(limbCount) {}
+
+    void assign(const uint64_t* value, std::size_t n, bool isNegative = false) noexcept
+    {
+        std::copy(value, value + n, magnitude);
+        std::fill(magnitude + n, magnitude + width, 0);
+        negative = isNegative;
+    }
+
+    /* *this += sign·other  (mesma largura) */
+    void add(const SignedLimbs& other, bool subtractOther = false) noexcept
+    {
+        const bool otherNegative = other.negative != subtractOther;
+        if (negative == otherNegative)
+        {
+            addN(magnitude, magnitude, other.magnitude, width);
+            return;
+        }
+        if (compareN(magnitude, other.magnitude, width) >= 0)
+            subN(magnitude, magnitude, other.magnitude, width);
+        else
+        {
+            subN(magnitude, other.magnitude, magnitude, width);
+            negative = otherNegative;
+        }
+    }
+
+    void shiftLeftOne() noexcept
+    {
+        uint64_t carry = 0;
+        for (std::size_t i = 0; i < width; ++i)
+        {
+            const uint64_t next = magnitude[i] >> 63;
+            magnitude[i] = (magnitude[i] << 1) | carry;
+            carry = next;
+        }
+    }
+
+    void halveExact() noexcept
+    {
+        for (std::size_t i = 0; i < width; ++i)
+        {
+            const uint64_t upper = (i + 1 < width) ? magnitude[i + 1] : 0;
+            magnitude[i] = (magnitude[i] >> 1) | (upper << 63);
+        }
+    }
+
+    void divideExactByThree() noexcept
+    {
+        uint64_t remainder = 0;                      // < 3
+        for (std::size_t i = width; i-- > 0;)
+        {
+            const uint64_t hi = (remainder << 32) | (magnitude[i] >> 32);
+            const uint64_t qHi = hi / 3;
+            remainder = hi % 3;
+            const uint64_t lo = (remainder << 32) | (magnitude[i] & 0xFFFFFFFFu);
+            const uint64_t qLo = lo / 3;
+            remainder = lo % 3;
+            magnitude[i] = (qHi << 32) | qLo;
+        }
+    }
+};
+
+/* Limbs de scratch usados pelo próprio nível de Toom-3 (sem a recursão) */
+constexpr std::size_t toom3LocalScratch(std::size_t k) noexcept
+{
+    return 6 * (k + 1) + 5 * (2 * k + 4);           // avaliações + v₁, v₋₁, v₋₂, v₀, v∞
+}
+
+/* Avaliação de x = x₂·B²ᵏ + x₁·Bᵏ + x₀ em 1, -1, -2 (k+1 limbs cada);
+   p1 serve de rascunho para x₀ + x₂ antes de receber p(1) */
+void toom3Evaluate(const uint64_t* x, std::size_t k, std::size_t len2,
+                   uint64_t* p1, SignedLimbs& pm1, SignedLimbs& pm2) noexcept
+{
+    const uint64_t* x0 = x;
+    const uint64_t* x1 = x + k;
+    const uint64_t* x2 = x + 2 * k;
+
+    uint64_t* sum02 = pm2.magnitude;                                 // x₀ + x₂
+    std::copy(x0, x0 + k, sum02);
+    sum02[k] = 0;
+    addInto(sum02, k + 1, x2, len2);
+
+    std::copy(sum02, sum02 + k + 1, p1);                             // x₀ + x₁ + x₂
+    addInto(p1, k + 1, x1, k);
+
+    pm1.negative = absoluteDifference(pm1.magnitude, sum02, k + 1, x1, k);
+
+    /* p(-2) = 2·(p(-1) + x₂) - x₀, com x₂ e x₀ somados/subtraídos direto
+       nos limbs de pm2 (x₂, x₀ ≥ 0; mesmas regras de sinal de add) */
+    pm2.assign(pm1.magnitude, k + 1, pm1.negative);
+    if (!pm2.negative)
+        addInto(pm2.magnitude, k + 1, x2, len2);
+    else if (absoluteDifference(pm2.magnitude, pm2.magnitude, k + 1, x2, len2))
+        pm2.negative = false;
+    pm2.shiftLeftOne();
+    if (pm2.negative)
+        addInto(pm2.magnitude, k + 1, x0, k);
+    else if (absoluteDifference(pm2.magnitude, pm2.magnitude, k + 1, x0, k))
+        pm2.negative = true;
+}
+
+void toom3(uint64_t* r, const uint64_t* a, const uint64_t* b,
+           std::size_t n, uint64_t* scratch)
+{
+    const bool square = (a == b);
+    const std::size_t k     = (n + 2) / 3;
+    const std::size_t len2  = n - 2 * k;            // tamanho de a₂, b₂
+    const std::size_t eval  = k + 1;                // largura das avaliações
+    const std::size_t width = 2 * k + 4;            // largura da interpolação
+
+    /* Tudo no scratch do chamador (ver toom3LocalScratch); a recursão
+       usa o que vem depois */
+    uint64_t* cursor = scratch;
+    auto take = [&cursor](std::size_t limbs) { uint64_t* block = cursor; cursor += limbs; return block; };
+    uint64_t*   aP1 = take(eval);
+    SignedLimbs aM1(take(eval), eval), aM2(take(eval), eval);
+    uint64_t*   bP1 = take(eval);
+    SignedLimbs bM1(take(eval), eval), bM2(take(eval), eval);
+    SignedLimbs v1(take(width), width), vm1(take(width), width), vm2(take(width), width);
+    SignedLimbs v0(take(width), width), vInf(take(width), width);
+    uint64_t* next = cursor;
+
+    toom3Evaluate(a, k, len2, aP1, aM1, aM2);
+    if (!square) toom3Evaluate(b, k, len2, bP1, bM1, bM2);
+    const uint64_t*    yP1 = square ? aP1 : bP1;
+    const SignedLimbs& yM1 = square ? aM1 : bM1;
+    const SignedLimbs& yM2 = square ? aM2 : bM2;
+
+    /* Produtos direto nas vistas (2·eval ≤ width limbs, resto zerado) */
+    auto productInto = [&](SignedLimbs& v, const uint64_t* x, const uint64_t* y, bool negative) {
+        large_multiply::multiply(v.magnitude, x, square ? x : y, eval, next);
+        std::fill(v.magnitude + 2 * eval, v.magnitude + width, 0);
+        v.negative = negative;
+    };
+    productInto(v1,  aP1,           yP1,           false);
+    productInto(vm1, aM1.magnitude, yM1.magnitude, aM1.negative != yM1.negative);
+    productInto(vm2, aM2.magnitude, yM2.magnitude, aM2.negative != yM2.negative);
+
+    /* v₀ e v∞ vão direto para as posições finais de r */
+    std::fill(r, r + 2 * n, 0);
+    large_multiply::multiply(r, a, square ? a : b, k, next);
+    large_multiply::multiply(r + 4 * k, a + 2 * k, square ? a + 2 * k : b + 2 * k,
+                             len2, next);
+    v0.assign(r, 2 * k);
+    vInf.assign(r + 4 * k, 2 * len2);
+
+    /* Interpolação no lugar: r₃ em vm2, r₁ em v1, r₂ em vm1 */
+    SignedLimbs& r3 = vm2;  r3.add(v1, true);   r3.divideExactByThree();   // (v₋₂ - v₁)/3
+    SignedLimbs& r1 = v1;   r1.add(vm1, true);  r1.halveExact();           // (v₁ - v₋₁)/2
+    SignedLimbs& r2 = vm1;  r2.add(v0, true);                              // v₋₁ - v₀
+    r3.negative = !r3.negative; r3.add(r2);     r3.halveExact();           // (r₂ - r₃)/2
+    r3.add(vInf);           r3.add(vInf);                                  //   + 2v∞
+    r2.add(r1);             r2.add(vInf, true);
+    r1.add(r3, true);
+
+    /* Recomposição (r₁, r₂, r₃ ≥ 0) */
+    auto accumulate = [&](const SignedLimbs& coefficient, std::size_t offset) {
+        const std::size_t room = 2 * n - offset;
+        addInto(r + offset, room, coefficient.magnitude, std::min(room, coefficient.width));
+    };
+    accumulate(r1, k);
+    accumulate(r2, 2 * k);
+    accumulate(r3, 3 * k);
+}
+} // namespace
+
+/* ---------------- Despacho -------------------------------------------- */
+
+std::size_t large_multiply::scratchSize(std::size_t n) noexcept
+{
+    if (n < KARATSUBA_THRESHOLD) return 0;
+    if (n < TOOM3_THRESHOLD)
+    {
+        const std::size_t low = (n + 1) / 2;
+        return 4 * low + std::max(2 * low + 1, scratchSize(low));
+    }
+    const std::size_t k = (n + 2) / 3;
+    return toom3LocalScratch(k) + std::max(scratchSize(k), scratchSize(k + 1));
+}
+
+void large_multiply::multiply(uint64_t* product, const uint64_t* a, const uint64_t* b,
+                              std::size_t n, uint64_t* scratch)
+{
+    if (n < KARATSUBA_THRESHOLD)
+    {
+        if (a == b) squareBasecase(product, a, n);
+        else        multiplyBasecase(product, a, b, n);
+    }
+    else if (n < TOOM3_THRESHOLD) karatsuba(product, a, b, n, scratch);
+    else                          toom3(product, a, b, n, scratch);
+}
+
+/* ---------------- LargeMontgomeryContext ------------------------------ */
+
+LargeMontgomeryContext::LargeMontgomeryContext(const BigInt& modulus)
+{
+    if ((modulus & 1) == 0 || modulus < 3)
+        throw std::invalid_argument("Montgomery modulus must be odd and ≥ 3");
+
+    const unsigned bits = boost::multiprecision::msb(modulus) + 1;
+    limbs_ = (bits + 63) / 64;
+    const unsigned rBits = static_cast<unsigned>(64 * limbs_);
+
+    modulus_      = load(modulus);
+    modulusPrime_ = negativeInverse(modulus_[0]);
+
+    const BigInt r = (BigInt(1) << rBits) % modulus;
+    one_      = load(r);
+    rSquared_ = load((r * r) % modulus);
+    minusOne_ = load(modulus - r);
+
+    /* n⁻¹ mod R por Newton (dobra a precisão a cada passo) */
+    BigInt inverse = ~modulusPrime_ + 1;               // n⁻¹ mod 2⁶⁴
+    for (unsigned precision = 64; precision < rBits;)
+    {
+        precision = std::min(2 * precision, rBits);
+        const BigInt mask = (BigInt(1) << precision) - 1;
+        inverse = (inverse * (2 + (mask + 1) - ((modulus * inverse) & mask))) & mask;
+    }
+    modulusPrimeWide_ = load(((BigInt(1) << rBits) - inverse) & ((BigInt(1) << rBits) - 1));
+
+    product_.resize(2 * limbs_);
+    reduction_.resize(2 * limbs_);
+    scratch_.resize(std::max<std::size_t>(large_multiply::scratchSize(limbs_), 1) + limbs_);
+}
+
+LargeMontgomeryContext::Number LargeMontgomeryContext::load(const BigInt& value) const
+{
+    Number out(limbs_, 0);
+    boost::multiprecision::export_bits(value, out.begin(), 64, false);
+    return out;
+}
+
+LargeMontgomeryContext::Number
+LargeMontgomeryContext::toMontgomery(const Number& value) const
+{
+    Number out;
+    montMul(out, value, rSquared_);
+    return out;
+}
+
+BigInt LargeMontgomeryContext::fromMontgomery(const Number& value) const
+{
+    Number unit(limbs_, 0);
+    unit[0] = 1;
+    Number plain;
+    montMul(plain, value, unit);
+    BigInt out;
+    boost::multiprecision::import_bits(out, plain.begin(), plain.end(), 64, false);
+    return out;
+}
+
+void LargeMontgomeryContext::modAdd(Number& out, const Number& a, const Number& b) const
+{
+    const std::size_t n = limbs_;
+    out.resize(n);
+    const uint64_t carry = addN(out.data(), a.data(), b.data(), n);
+    if (carry || compareN(out.data(), modulus_.data(), n) >= 0)
+        subN(out.data(), out.data(), modulus_.data(), n);
+}
+
+void LargeMontgomeryContext::modSub(Number& out, const Number& a, const Number& b) const
+{
+    const std::size_t n = limbs_;
+    out.resize(n);
+    if (subN(out.data(), a.data(), b.data(), n))
+        addN(out.data(), out.data(), modulus_.data(), n);
+}
+
+void LargeMontgomeryContext::modHalve(Number& out, const Number& a) const
+{
+    const std::size_t n = limbs_;
+    out.resize(n);
+    uint64_t carry = 0;
+    if (a[0] & 1u) carry = addN(out.data(), a.data(), modulus_.data(), n);
+    else           std::copy(a.begin(), a.end(), out.begin());
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        const uint64_t upper = (i + 1 < n) ? out[i + 1] : carry;
+        out[i] = (out[i] >> 1) | (upper << 63);
+    }
+}
+
+void LargeMontgomeryContext::montMul(Number& out, const Number& a, const Number& b) const
+{
+    if (limbs_ < large_multiply::SUBQUADRATIC_REDC_THRESHOLD) montMulCios(out, a, b);
+    else                                                      montMulSubquadratic(out, a, b);
+}
+
+void LargeMontgomeryContext::montMulCios(Number& out, const Number& a, const Number& b) const
+{
+    const std::size_t n = limbs_;
+    uint64_t* t = product_.data();                      // n + 2 limbs
+    std::fill(t, t + n + 2, 0);
+
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        uint64_t carry = 0;
+        for (std::size_t j = 0; j < n; ++j)
+            t[j] = mulAdd(a[j], b[i], t[j], carry, carry);
+        uint64_t c2 = 0;
+        t[n]     = addCarry(t[n], carry, c2);
+        t[n + 1] = c2;
+
+        const uint64_t m = t[0] * modulusPrime_;
+        mulAdd(m, modulus_[0], t[0], 0, carry);
+        for (std::size_t j = 1; j < n; ++j)
+            t[j - 1] = mulAdd(m, modulus_[j], t[j], carry, carry);
+        c2 = 0;
+        t[n - 1] = addCarry(t[n], carry, c2);
+        t[n]     = t[n + 1] + c2;
+    }
+
+    out.resize(n);
+    const bool reduce = t[n] || compareN(t, modulus_.data(), n) >= 0;
+    if (reduce) subN(out.data(), t, modulus_.data(), n);
+    else        std::copy(t, t + n, out.begin());
+}
+
+void LargeMontgomeryContext::montMulSubquadratic(Number& out, const Number& a,
+                                                 const Number& b) const
+{
+    const std::size_t n = limbs_;
+    uint64_t* scratch = scratch_.data() + n;
+    uint64_t* m       = scratch_.data();                // n limbs
+
+    /* T = a·b */
+    large_multiply::multiply(product_.data(), a.data(),
+                             (&a == &b) ? a.data() : b.data(), n, scratch);
+    /* m = (T mod R)·n' mod R */
+    large_multiply::multiply(reduction_.data(), product_.data(),
+                             modulusPrimeWide_.data(), n, scratch);
+    std::copy(reduction_.begin(), reduction_.begin() + n, m);
+    /* (T + m·n) / R */
+    large_multiply::multiply(reduction_.data(), m, modulus_.data(), n, scratch);
+    const uint64_t carry = addN(product_.data(), product_.data(), reduction_.data(), 2 * n);
+
+    const uint64_t* upper = product_.data() + n;
+    out.resize(n);
+    const bool reduce = carry || compareN(upper, modulus_.data(), n) >= 0;
+    if (reduce) subN(out.data(), upper, modulus_.data(), n);
+    else        std::copy(upper, upper + n, out.begin());
+}
+
+void LargeMontgomeryContext::montPow(Number& out, const Number& base,
+                                     const Number& exponent,
+                                     const CancellationToken* cancel) const
+{
+    constexpr unsigned WINDOW = 6;
+    constexpr unsigned TABLE_SIZE = 1u << (WINDOW - 1);
+    keygen_stats::ModExpTimer modExpTimer;
+
+    int topBit = -1;
+    for (std::size_t limb = exponent.size(); limb-- > 0 && topBit < 0;)
+        for (int bit = 63; bit >= 0; --bit)
+            if ((exponent[limb] >> bit) & 1u) { topBit = static_cast<int>(limb * 64) + bit; break; }
+    if (topBit < 0) { out = one_; return; }
+
+    std::vector<Number> table(TABLE_SIZE);               // base^(2k+1)
+    table[0] = base;
+    Number baseSquared;
+    montSqr(baseSquared, base);
+    for (unsigned k = 1; k < TABLE_SIZE; ++k) montMul(table[k], table[k - 1], baseSquared);
+
+    auto bitAt = [&exponent](int i) -> unsigned {
+        return static_cast<unsigned>(exponent[i / 64] >> (i % 64)) & 1u;
+    };
+
+    Number result = one_;
+    bool started = false;
+    for (int i = topBit; i >= 0;)
+    {
+        if (cancel && cancel->isCancelled()) break;
+        if (!bitAt(i))
+        {
+            if (started) montSqr(result, result);
+            --i;
+            continue;
+        }
+        int low = std::max(i - static_cast<int>(WINDOW) + 1, 0);
+        while (!bitAt(low)) ++low;
+
+        unsigned windowValue = 0;
+        for (int k = i; k >= low; --k) windowValue = (windowValue << 1) | bitAt(k);
+
+        if (started)
+        {
+            for (int k = i; k >= low; --k) montSqr(result, result);
+            montMul(result, result, table[windowValue >> 1]);
+        }
+        else
+        {
+            result = table[windowValue >> 1];
+            started = true;
+        }
+        i = low - 1;
+    }
+    out = std::move(result);
+}
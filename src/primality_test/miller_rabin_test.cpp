@@ -10,16 +10,24 @@
  *          Se xᵢ == n-1 ⇒ possivelmente primo
  *          Se xᵢ == 1   ⇒ composto
  *  Se nenhuma iteração encontra n-1 ⇒ composto.
+ *  Antes das rodadas, um Fermat na base 2 (só quadrados e dobras)
+ *  descarta quase todos os compostos que passaram pela divisão.
+ *  O token de cancelamento é consultado a cada rodada, a cada janela
+ *  da exponenciação e a cada quadrado.
  *──────────────────────────────────────────────────────────────*/
 #include "miller_rabin_test.h"
+#include "montgomery.h"
+#include "native64.h"
+#include "base2_fermat.h"
 #include <boost/multiprecision/cpp_int.hpp>
-#include "../fast_divisibility.h"
+#include "../trial_division.h"
 
 using BigInt = boost::multiprecision::cpp_int;
 
 bool MillerRabinTest::isPrime(const BigInt& modulusUnderTest,
                               int witnessIterations,
-                              PRNG& randomGenerator)
+                              PRNG& randomGenerator,
+                              const CancellationToken& cancel)
 {
     if (modulusUnderTest <= 1) return false;
     if (modulusUnderTest == 2 || modulusUnderTest == 3) return true;
@@ -29,6 +37,10 @@ bool MillerRabinTest::isPrime(const BigInt& modulusUnderTest,
     if (isCompositeByTrialDivision(modulusUnderTest))
         return false;
 
+    /* n < 2⁶⁴: bases determinísticas, aritmética nativa, sem PRNG */
+    if (boost::multiprecision::msb(modulusUnderTest) < 64)
+        return isPrimeDeterministic64(static_cast<uint64_t>(modulusUnderTest));
+
     /* n-1 = oddComponent · 2^powerOfTwoExponent */
     BigInt oddComponent;
     unsigned powerOfTwoExponent;
@@ -36,33 +48,46 @@ bool MillerRabinTest::isPrime(const BigInt& modulusUnderTest,
     // Decompor n-1
     decompose(nMinusOne, powerOfTwoExponent, oddComponent);
 
-    for (int iteration = 0; iteration < witnessIterations; ++iteration)
+    /* Rodadas no domínio de Montgomery: contexto de largura fixa até 4096
+       bits, Karatsuba/Toom-3 acima disso */
+    return withMontgomeryContext(modulusUnderTest, [&](const auto& ctx)
     {
-        BigInt candidateWitness =
-            generateWitness(modulusUnderTest, randomGenerator);
-        
-        if (boost::math::gcd(candidateWitness, modulusUnderTest) != 1)
-            return false;
-        // gcd(a, n) != 1 ⇒ witness não é primo
-        BigInt currentPower =
-            boost::multiprecision::powm(candidateWitness,
-                                        oddComponent,
-                                        modulusUnderTest);
-        // x₀ = a^d mod n
-        if (currentPower == 1 || currentPower == nMinusOne)
-            continue;                                            // Próxima witness
+        using Number = typename std::decay_t<decltype(ctx)>::Number;
+        const Number exponent = ctx.load(oddComponent);
+        Number currentPower;
 
-        // x₀ ∈ {1, n-1} ⇒ possivelmente primo
-        bool hitMinusOne = false;
-        for (unsigned j = 1; j < powerOfTwoExponent; ++j)
+        /* Filtro: 2^(n-1) ≢ 1  ⇒  composto */
+        if (base2Prefilter_)
         {
-            currentPower =
-                boost::multiprecision::powm(currentPower, 2, modulusUnderTest);
+            montPowBase2(ctx, currentPower, ctx.load(nMinusOne), &cancel);
+            if (cancel.isCancelled() || currentPower != ctx.one()) return false;
+        }
+        BigInt candidateWitness;                        // limbs reaproveitados
+
+        for (int iteration = 0; iteration < witnessIterations; ++iteration)
+        {
+            if (cancel.isCancelled()) return false;
+            keygen_stats::add(&KeyGenerationStats::millerRabinRounds);
+            /* Sem gcd(a, n): n já passou pela divisão por tentativa, e um
+               a com fator comum nunca dá ±1 — a rodada o declara composto */
+            nextWitness(modulusUnderTest, iteration, randomGenerator, candidateWitness);
+
+            // x₀ = a^d mod n
+            ctx.montPow(currentPower, ctx.toMontgomery(candidateWitness), exponent, &cancel);
+            if (cancel.isCancelled()) return false;
+            if (currentPower == ctx.one() || currentPower == ctx.minusOne())
+                continue;
 
-            if (currentPower == nMinusOne) { hitMinusOne = true; break; }
-            if (currentPower == 1)          return false;        // Raiz proibida
+            bool hitMinusOne = false;
+            for (unsigned j = 1; j < powerOfTwoExponent; ++j)
+            {
+                if (cancel.isCancelled()) return false;
+                ctx.montSqr(currentPower, currentPower);       // xᵢ = xᵢ₋₁²
+                if (currentPower == ctx.minusOne()) { hitMinusOne = true; break; }
+                if (currentPower == ctx.one())       return false;
+            }
+            if (!hitMinusOne) return false;
         }
-        if (!hitMinusOne) return false;                          // Composto
-    }
-    return true;
+        return true;
+    });
 }
@@ -1,14 +1,22 @@
+#pragma once
 #include "primality_test.h"
 #include <boost/multiprecision/miller_rabin.hpp>
-#include "../fast_divisibility.h"
+#include "../trial_division.h"
 
 using BigInt = boost::multiprecision::cpp_int;
 
-class MillerRabinTest : public PrimalityTest
+class MillerRabinTest final : public PrimalityTest
 {
+    bool base2Prefilter_ {true};
+
 public:
+    // Fermat na base 2 (exponenciação por dobras, ver base2_fermat.h)
+    // antes das rodadas aleatórias: os compostos param ali, sem witness.
+    void setBase2Prefilter(bool enabled) noexcept { base2Prefilter_ = enabled; }
+
      [[nodiscard]] bool isPrime(
         const BigInt &n,
         int iterations,
-        PRNG &prng) override;
+        PRNG &prng,
+        const CancellationToken &cancel = CancellationToken{}) override;
 };
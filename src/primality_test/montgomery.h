@@ -0,0 +1,383 @@
+#pragma once
+/*──────────────────────────────────────────────────────────────
+ *  Aritmética de Montgomery com largura fixa.
+ *
+ *  MontgomeryContext<Bits> opera sobre  Bits/64  limbs de 64 bits
+ *  guardados em std::array (pilha, sem alocação). Para n ímpar e
+ *  R = 2^Bits:
+ *      montMul(a, b) = a·b·R⁻¹ mod n        (CIOS)
+ *      montSqr(a)    = a²·R⁻¹  mod n        (quadrado + REDC)
+ *      montPow(a, e) = a^e     (domínio de Montgomery, janela deslizante;
+ *                               interrompível por CancellationToken)
+ *──────────────────────────────────────────────────────────────*/
+#include "large_montgomery.h"
+#include "keygen_stats.h"
+#include <boost/multiprecision/cpp_int.hpp>
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+
+using BigInt = boost::multiprecision::cpp_int;
+
+namespace montgomery_detail {
+
+#if defined(__SIZEOF_INT128__)
+__extension__ typedef unsigned __int128 UInt128;
+
+/* (hi, lo) = a·b + c + d   — nunca transborda 128 bits */
+inline uint64_t mulAdd(uint64_t a, uint64_t b, uint64_t c, uint64_t d,
+                       uint64_t& hi) noexcept
+{
+    const UInt128 t = static_cast<UInt128>(a) * b + c + d;
+    hi = static_cast<uint64_t>(t >> 64);
+    return static_cast<uint64_t>(t);
+}
+#else
+inline uint64_t mulAdd(uint64_t a, uint64_t b, uint64_t c, uint64_t d,
+                       uint64_t& hi) noexcept
+{
+    const uint64_t aLo = a & 0xFFFFFFFFu, aHi = a >> 32;
+    const uint64_t bLo = b & 0xFFFFFFFFu, bHi = b >> 32;
+    const uint64_t ll = aLo * bLo, lh = aLo * bHi, hl = aHi * bLo, hh = aHi * bHi;
+    const uint64_t mid = (ll >> 32) + (lh & 0xFFFFFFFFu) + (hl & 0xFFFFFFFFu);
+    uint64_t lo = (ll & 0xFFFFFFFFu) | (mid << 32);
+    hi = hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+    lo += c; hi += (lo < c);
+    lo += d; hi += (lo < d);
+    return lo;
+}
+#endif
+
+/* (carry, sum) = a + b + carryIn */
+inline uint64_t addCarry(uint64_t a, uint64_t b, uint64_t& carry) noexcept
+{
+    const uint64_t s = a + carry;
+    uint64_t c = (s < a);
+    const uint64_t r = s + b;
+    c += (r < s);
+    carry = c;
+    return r;
+}
+
+/* (borrow, diff) = a - b - borrowIn */
+inline uint64_t subBorrow(uint64_t a, uint64_t b, uint64_t& borrow) noexcept
+{
+    const uint64_t d = a - b;
+    uint64_t c = (a < b);
+    const uint64_t r = d - borrow;
+    c += (d < borrow);
+    borrow = c;
+    return r;
+}
+
+/* -n⁻¹ mod 2⁶⁴ por iteração de Newton */
+constexpr uint64_t negativeInverse(uint64_t n0) noexcept
+{
+    uint64_t inverse = n0;
+    for (int i = 0; i < 5; ++i) inverse *= 2 - n0 * inverse;
+    return ~inverse + 1;
+}
+
+} // namespace montgomery_detail
+
+template <unsigned Bits>
+class MontgomeryContext
+{
+    static_assert(Bits % 64 == 0, "Bits must be a multiple of 64");
+
+public:
+    static constexpr unsigned LIMBS = Bits / 64;
+    using Number = std::array<uint64_t, LIMBS>;        // little-endian
+
+    /** n ímpar, 3 ≤ n < 2^Bits. */
+    explicit MontgomeryContext(const BigInt& modulus)
+    {
+        if ((modulus & 1) == 0 || modulus < 3 ||
+            boost::multiprecision::msb(modulus) >= Bits)
+            throw std::invalid_argument("Montgomery modulus must be odd and fit in Bits");
+
+        modulus_  = load(modulus);
+        nPrime_   = montgomery_detail::negativeInverse(modulus_[0]);
+
+        const BigInt r = (BigInt(1) << Bits) % modulus;   // R mod n
+        one_      = load(r);
+        rSquared_ = load((r * r) % modulus);              // R² mod n
+        minusOne_ = subtract(modulus_, one_);             // (n-1)·R mod n
+    }
+
+    /* ---------------- Conversões ------------------------------------- */
+
+    /** Copia um BigInt (< 2^Bits) para limbs, sem conversão de domínio. */
+    [[nodiscard]] static Number load(const BigInt& value)
+    {
+        Number out{};
+        boost::multiprecision::export_bits(value, out.begin(), 64, false);
+        return out;
+    }
+
+    [[nodiscard]] Number toMontgomery(const Number& value) const noexcept
+    {
+        Number out;
+        montMul(out, value, rSquared_);
+        return out;
+    }
+    [[nodiscard]] Number toMontgomery(const BigInt& value) const
+    {
+        return toMontgomery(load(value));
+    }
+
+    [[nodiscard]] BigInt fromMontgomery(const Number& value) const
+    {
+        Number unit{};
+        unit[0] = 1;
+        Number plain;
+        montMul(plain, value, unit);
+        BigInt out;
+        boost::multiprecision::import_bits(out, plain.begin(), plain.end(), 64, false);
+        return out;
+    }
+
+    [[nodiscard]] const Number& modulus()  const noexcept { return modulus_; }
+    [[nodiscard]] const Number& one()      const noexcept { return one_; }       // 1·R
+    [[nodiscard]] const Number& minusOne() const noexcept { return minusOne_; }  // (n-1)·R
+
+    /* ---------------- Operações -------------------------------------- */
+
+    /** out = a + b mod n   (a, b < n; vale em qualquer domínio). */
+    void modAdd(Number& out, const Number& a, const Number& b) const noexcept
+    {
+        uint64_t sum[LIMBS];
+        uint64_t carry = 0;
+        for (unsigned i = 0; i < LIMBS; ++i)
+            sum[i] = montgomery_detail::addCarry(a[i], b[i], carry);
+        finalSubtract(out, sum, carry);
+    }
+
+    /** out = a - b mod n. */
+    void modSub(Number& out, const Number& a, const Number& b) const noexcept
+    {
+        uint64_t borrow = 0;
+        for (unsigned i = 0; i < LIMBS; ++i)
+            out[i] = montgomery_detail::subBorrow(a[i], b[i], borrow);
+        if (!borrow) return;
+        uint64_t carry = 0;
+        for (unsigned i = 0; i < LIMBS; ++i)
+            out[i] = montgomery_detail::addCarry(out[i], modulus_[i], carry);
+    }
+
+    /** out = a / 2 mod n   (soma n se a for ímpar; comuta com o fator R). */
+    void modHalve(Number& out, const Number& a) const noexcept
+    {
+        uint64_t carry = 0;
+        if (a[0] & 1u)
+            for (unsigned i = 0; i < LIMBS; ++i)
+                out[i] = montgomery_detail::addCarry(a[i], modulus_[i], carry);
+        else
+            out = a;
+        for (unsigned i = 0; i < LIMBS; ++i)
+        {
+            const uint64_t upper = (i + 1 < LIMBS) ? out[i + 1] : carry;
+            out[i] = (out[i] >> 1) | (upper << 63);
+        }
+    }
+
+    /** out = a·b·R⁻¹ mod n   (CIOS, out pode coincidir com a ou b). */
+    void montMul(Number& out, const Number& a, const Number& b) const noexcept
+    {
+        using namespace montgomery_detail;
+        uint64_t t[LIMBS + 2] = {};
+
+        for (unsigned i = 0; i < LIMBS; ++i)
+        {
+            uint64_t carry = 0;
+            for (unsigned j = 0; j < LIMBS; ++j)
+                t[j] = mulAdd(a[j], b[i], t[j], carry, carry);
+            uint64_t c2 = 0;
+            t[LIMBS]     = addCarry(t[LIMBS], carry, c2);
+            t[LIMBS + 1] = c2;
+
+            const uint64_t m = t[0] * nPrime_;
+            mulAdd(m, modulus_[0], t[0], 0, carry);
+            for (unsigned j = 1; j < LIMBS; ++j)
+                t[j - 1] = mulAdd(m, modulus_[j], t[j], carry, carry);
+            c2 = 0;
+            t[LIMBS - 1] = addCarry(t[LIMBS], carry, c2);
+            t[LIMBS]     = t[LIMBS + 1] + c2;
+        }
+        finalSubtract(out, t, t[LIMBS]);
+    }
+
+    /** out = a²·R⁻¹ mod n  — produtos cruzados calculados uma só vez. */
+    void montSqr(Number& out, const Number& a) const noexcept
+    {
+        using namespace montgomery_detail;
+        uint64_t t[2 * LIMBS] = {};
+
+        /* Produtos cruzados a[i]·a[j], i < j */
+        for (unsigned i = 0; i < LIMBS; ++i)
+        {
+            uint64_t carry = 0;
+            for (unsigned j = i + 1; j < LIMBS; ++j)
+                t[i + j] = mulAdd(a[i], a[j], t[i + j], carry, carry);
+            t[i + LIMBS] = carry;
+        }
+        /* Dobra (shift de 1 bit) */
+        uint64_t shifted = 0;
+        for (unsigned k = 0; k < 2 * LIMBS; ++k)
+        {
+            const uint64_t next = t[k] >> 63;
+            t[k] = (t[k] << 1) | shifted;
+            shifted = next;
+        }
+        /* Soma a diagonal a[i]² */
+        uint64_t carry = 0;
+        for (unsigned i = 0; i < LIMBS; ++i)
+        {
+            uint64_t hi;
+            const uint64_t lo = mulAdd(a[i], a[i], 0, 0, hi);
+            t[2 * i]     = addCarry(t[2 * i], lo, carry);
+            t[2 * i + 1] = addCarry(t[2 * i + 1], hi, carry);
+        }
+        reduce(out, t);
+    }
+
+    /**
+     * out = base^exponent  (base e out no domínio de Montgomery).
+     * Janela deslizante com potências ímpares pré-calculadas.
+     */
+    void montPow(Number& out, const Number& base, const Number& exponent,
+                 const CancellationToken* cancel = nullptr) const noexcept
+    {
+        constexpr unsigned WINDOW = (Bits >= 1024) ? 5 : 4;
+        constexpr unsigned TABLE_SIZE = 1u << (WINDOW - 1);
+        keygen_stats::ModExpTimer modExpTimer;
+
+        int topBit = -1;
+        for (int limb = LIMBS - 1; limb >= 0 && topBit < 0; --limb)
+            if (exponent[limb])
+                topBit = limb * 64 + 63 - countLeadingZeros(exponent[limb]);
+        if (topBit < 0) { out = one_; return; }
+
+        /* table[k] = base^(2k+1) */
+        Number table[TABLE_SIZE];
+        table[0] = base;
+        Number baseSquared;
+        montSqr(baseSquared, base);
+        for (unsigned k = 1; k < TABLE_SIZE; ++k)
+            montMul(table[k], table[k - 1], baseSquared);
+
+        auto bitAt = [&exponent](int i) -> unsigned {
+            return static_cast<unsigned>(exponent[i / 64] >> (i % 64)) & 1u;
+        };
+
+        Number result = one_;
+        bool started = false;
+        for (int i = topBit; i >= 0;)
+        {
+            if (cancel && cancel->isCancelled()) break;   // resultado descartado
+            if (!bitAt(i))
+            {
+                if (started) montSqr(result, result);
+                --i;
+                continue;
+            }
+            /* Janela [low, i] terminando em bit 1 */
+            int low = std::max(i - static_cast<int>(WINDOW) + 1, 0);
+            while (!bitAt(low)) ++low;
+
+            unsigned windowValue = 0;
+            for (int k = i; k >= low; --k) windowValue = (windowValue << 1) | bitAt(k);
+
+            if (started)
+            {
+                for (int k = i; k >= low; --k) montSqr(result, result);
+                montMul(result, result, table[windowValue >> 1]);
+            }
+            else
+            {
+                result = table[windowValue >> 1];
+                started = true;
+            }
+            i = low - 1;
+        }
+        out = result;
+    }
+
+private:
+    static unsigned countLeadingZeros(uint64_t value) noexcept
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return static_cast<unsigned>(__builtin_clzll(value));
+#else
+        unsigned zeros = 0;
+        for (uint64_t mask = uint64_t{1} << 63; !(value & mask); mask >>= 1) ++zeros;
+        return zeros;
+#endif
+    }
+
+    static Number subtract(const Number& a, const Number& b) noexcept
+    {
+        Number out;
+        uint64_t borrow = 0;
+        for (unsigned i = 0; i < LIMBS; ++i)
+            out[i] = montgomery_detail::subBorrow(a[i], b[i], borrow);
+        return out;
+    }
+
+    /** out = t  ou  t - n, com t = (topCarry : t[0..LIMBS-1]) < 2n. */
+    void finalSubtract(Number& out, const uint64_t* t, uint64_t topCarry) const noexcept
+    {
+        Number diff;
+        uint64_t borrow = 0;
+        for (unsigned i = 0; i < LIMBS; ++i)
+            diff[i] = montgomery_detail::subBorrow(t[i], modulus_[i], borrow);
+
+        if (topCarry || !borrow) out = diff;
+        else for (unsigned i = 0; i < LIMBS; ++i) out[i] = t[i];
+    }
+
+    /** REDC de um produto de 2·LIMBS limbs:  out = t·R⁻¹ mod n. */
+    void reduce(Number& out, uint64_t* t) const noexcept
+    {
+        using namespace montgomery_detail;
+        uint64_t topCarry = 0;
+        for (unsigned i = 0; i < LIMBS; ++i)
+        {
+            const uint64_t m = t[i] * nPrime_;
+            uint64_t carry = 0;
+            for (unsigned j = 0; j < LIMBS; ++j)
+                t[i + j] = mulAdd(m, modulus_[j], t[i + j], carry, carry);
+            uint64_t c2 = topCarry;
+            t[i + LIMBS] = addCarry(t[i + LIMBS], carry, c2);
+            topCarry = c2;
+        }
+        finalSubtract(out, t + LIMBS, topCarry);
+    }
+
+    Number   modulus_{};
+    Number   one_{};
+    Number   minusOne_{};
+    Number   rSquared_{};
+    uint64_t nPrime_{0};
+};
+
+/* Maior módulo atendido pelos contextos de largura fixa */
+inline constexpr unsigned MONTGOMERY_MAX_BITS = 4096;
+
+/**
+ * Executa  visitor(ctx)  com o menor MontgomeryContext (512/1024/2048/3072/4096)
+ * capaz de representar n; acima de 4096 bits usa LargeMontgomeryContext
+ * (Karatsuba/Toom-3). Requer n ímpar.
+ */
+template <class Visitor>
+decltype(auto) withMontgomeryContext(const BigInt& n, Visitor&& visitor)
+{
+    const unsigned bits = boost::multiprecision::msb(n) + 1;
+    if (bits <= 512)  { const MontgomeryContext<512>  ctx(n); return visitor(ctx); }
+    if (bits <= 1024) { const MontgomeryContext<1024> ctx(n); return visitor(ctx); }
+    if (bits <= 2048) { const MontgomeryContext<2048> ctx(n); return visitor(ctx); }
+    if (bits <= 3072) { const MontgomeryContext<3072> ctx(n); return visitor(ctx); }
+    if (bits <= 4096) { const MontgomeryContext<4096> ctx(n); return visitor(ctx); }
+    const LargeMontgomeryContext ctx(n);
+    return visitor(ctx);
+}
@@ -0,0 +1,126 @@
+#pragma once
+/*──────────────────────────────────────────────────────────────
+ *  Caminho nativo para módulos  n < 2⁶⁴.
+ *
+ *  Montgomery64 faz a redução com R = 2⁶⁴ sobre uint64_t (produto de
+ *  128 bits via montgomery_detail::mulAdd), sem BigInt e sem alocação.
+ *  isPrimeDeterministic64 usa as 7 bases de Jaeschke/Sinclair
+ *  {2, 325, 9375, 28178, 450775, 9780504, 1795265022}, exatas para
+ *  todo n < 2⁶⁴ — nenhum PRNG é necessário.
+ *──────────────────────────────────────────────────────────────*/
+#include "montgomery.h"
+#include <array>
+#include <cstdint>
+
+class Montgomery64
+{
+public:
+    /** n ímpar, n ≥ 3. */
+    explicit Montgomery64(uint64_t modulus) noexcept
+        : modulus_(modulus),
+          nPrime_(montgomery_detail::negativeInverse(modulus))
+    {
+        one_ = (0 - modulus) % modulus;                    // 2⁶⁴ mod n
+        uint64_t r2 = one_;                                 // 2¹²⁸ mod n  (64 dobras)
+        for (int i = 0; i < 64; ++i) r2 = addMod(r2, r2);
+        rSquared_ = r2;
+    }
+
+    [[nodiscard]] uint64_t modulus()  const noexcept { return modulus_; }
+    [[nodiscard]] uint64_t one()      const noexcept { return one_; }
+    [[nodiscard]] uint64_t minusOne() const noexcept { return modulus_ - one_; }
+
+    [[nodiscard]] uint64_t toMontgomery(uint64_t value) const noexcept
+    {
+        return mul(value % modulus_, rSquared_);
+    }
+
+    [[nodiscard]] uint64_t addMod(uint64_t a, uint64_t b) const noexcept
+    {
+        const uint64_t sum = a + b;
+        return (sum < a || sum >= modulus_) ? sum - modulus_ : sum;
+    }
+
+    /** a·b·2⁻⁶⁴ mod n */
+    [[nodiscard]] uint64_t mul(uint64_t a, uint64_t b) const noexcept
+    {
+        uint64_t hi;
+        const uint64_t lo = montgomery_detail::mulAdd(a, b, 0, 0, hi);
+        return reduce(hi, lo);
+    }
+
+    [[nodiscard]] uint64_t pow(uint64_t base, uint64_t exponent) const noexcept
+    {
+        keygen_stats::ModExpTimer modExpTimer;
+        uint64_t result = one_;
+        while (exponent)
+        {
+            if (exponent & 1u) result = mul(result, base);
+            base = mul(base, base);
+            exponent >>= 1;
+        }
+        return result;
+    }
+
+private:
+    /* REDC de (hi:lo) < n·2⁶⁴ */
+    [[nodiscard]] uint64_t reduce(uint64_t hi, uint64_t lo) const noexcept
+    {
+        const uint64_t m = lo * nPrime_;
+        uint64_t mnHi;
+        montgomery_detail::mulAdd(m, modulus_, 0, 0, mnHi);
+        /* lo + (m·n mod 2⁶⁴) vale 0 ou 2⁶⁴ */
+        const uint64_t carryIn = (lo != 0);
+        const uint64_t partial = hi + mnHi;
+        const uint64_t total   = partial + carryIn;
+        const bool overflow = (partial < hi) || (total < partial);
+        return (overflow || total >= modulus_) ? total - modulus_ : total;
+    }
+
+    uint64_t modulus_;
+    uint64_t nPrime_;
+    uint64_t one_ {0};
+    uint64_t rSquared_ {0};
+};
+
+/** Rodada forte de Miller–Rabin (a em forma normal, 2 ≤ a < n). */
+inline bool strongProbablePrime64(const Montgomery64& ctx, uint64_t witness,
+                                  uint64_t oddComponent, unsigned powerOfTwo) noexcept
+{
+    uint64_t x = ctx.pow(ctx.toMontgomery(witness), oddComponent);
+    if (x == ctx.one() || x == ctx.minusOne()) return true;
+    for (unsigned j = 1; j < powerOfTwo; ++j)
+    {
+        x = ctx.mul(x, x);
+        if (x == ctx.minusOne()) return true;
+        if (x == ctx.one())      return false;
+    }
+    return false;
+}
+
+/** Miller–Rabin determinístico para n < 2⁶⁴. */
+inline bool isPrimeDeterministic64(uint64_t n) noexcept
+{
+    if (n < 2) return false;
+    if (n < 4) return true;
+    if ((n & 1u) == 0) return false;
+
+    static constexpr std::array<uint64_t, 7> BASES = {
+        2, 325, 9375, 28178, 450775, 9780504, 1795265022
+    };
+
+    uint64_t oddComponent = n - 1;
+    unsigned powerOfTwo = 0;
+    while ((oddComponent & 1u) == 0) { oddComponent >>= 1; ++powerOfTwo; }
+
+    const Montgomery64 ctx(n);
+    for (uint64_t base : BASES)
+    {
+        const uint64_t witness = base % n;
+        if (witness == 0) continue;                       // base ≡ 0 não decide nada
+        keygen_stats::add(&KeyGenerationStats::millerRabinRounds);
+        if (!strongProbablePrime64(ctx, witness, oddComponent, powerOfTwo))
+            return false;
+    }
+    return true;
+}
@@ -4,41 +4,113 @@
  *──────────────────────────────────────────────────────────────*/
 #include <boost/multiprecision/cpp_int.hpp>
 #include "prng.h"
+#include "random_bits.h"
+#include "cancellation_token.h"
 #include <algorithm>
+#include <array>
+#include <cstdint>
 #include <stdexcept>
 
 using BigInt = boost::multiprecision::cpp_int;
 
+/* Como as rodadas de Miller–Rabin e Fermat escolhem a testemunha
+   (Baillie–PSW é determinístico e não usa testemunhas) */
+enum class WitnessMode
+{
+    FullRange,   // uniforme em [2, n-2], rejeição direto nos limbs (padrão)
+    Small64,     // uniforme em [2, 2⁶⁴-1]: um limb, sem redução modular
+    FixedBases   // 2, 3, 5, 7, … (rodada i ⇒ i-ésimo primo), sem PRNG
+};
+
 class PrimalityTest
 {
+    WitnessMode witnessMode_ {WitnessMode::FullRange};
+
+    /* Bases de WitnessMode::FixedBases: os 64 primeiros primos */
+    static constexpr std::array<uint16_t, 64> FIXED_BASES {
+          2,   3,   5,   7,  11,  13,  17,  19,  23,  29,  31,  37,  41,  43,  47,  53,
+         59,  61,  67,  71,  73,  79,  83,  89,  97, 101, 103, 107, 109, 113, 127, 131,
+        137, 139, 149, 151, 157, 163, 167, 173, 179, 181, 191, 193, 197, 199, 211, 223,
+        227, 229, 233, 239, 241, 251, 257, 263, 269, 271, 277, 281, 283, 293, 307, 311
+    };
+
+    /* Uniforme em [2, 2⁶⁴-1] (mesma ordem de palavras do caso nativo) */
+    static uint64_t smallWitness(PRNG& prng)
+    {
+        uint64_t raw;
+        uint32_t halves[2];
+        do {
+            prng.fill(halves, 2);
+            raw = (static_cast<uint64_t>(halves[0]) << 32) | halves[1];
+        } while (raw < 2);
+        return raw;
+    }
+
 protected:
-    /** Gera witness uniforme no intervalo [2, modulusUnderTest-2].           */
-    BigInt generateWitness(const BigInt& modulusUnderTest, PRNG& prng)
+    /** Witness uniforme em [2, modulusUnderTest-2], escrita em  witness
+        (limbs reaproveitados): r de msb(n)+1 bits, aceito se r+3 < n. */
+    void generateWitness(const BigInt& modulusUnderTest, PRNG& prng, BigInt& witness)
     {
         if (modulusUnderTest <= 3)
             throw std::invalid_argument("modulusUnderTest must be > 3");
 
-        /* Tamanho do intervalo interno: [0, modulus-4]  ⇒  modulus-3 valores */
-        const BigInt intervalSize = modulusUnderTest - 3;
-        const unsigned requiredBits =
-            boost::multiprecision::msb(intervalSize) + 65;      // +64 ⇢ menos viés
+        const unsigned bits = boost::multiprecision::msb(modulusUnderTest) + 1;
+        do {
+            fillRandomBits(prng, bits, witness);
+            witness += 3;                                  // in-place, sem temporário
+        } while (witness >= modulusUnderTest);             // rejeita r > n-4 (< 1/2)
+        witness -= 1;                                      // r + 2
+    }
 
-        const unsigned bitsPerPRNGCall = 32;
-        BigInt rawRandomValue{0};
-        unsigned bitsCollected = 0;
+    /** Versão nativa (3 < n < 2⁶⁴): witness uniforme em [2, n-2] por rejeição. */
+    uint64_t generateWitness(uint64_t modulusUnderTest, PRNG& prng)
+    {
+        if (modulusUnderTest <= 3)
+            throw std::invalid_argument("modulusUnderTest must be > 3");
 
-        while (bitsCollected < requiredBits)
+        const uint64_t intervalSize = modulusUnderTest - 3;
+        /* Maior múltiplo de intervalSize que cabe em 2⁶⁴ ⇒ sem viés */
+        const uint64_t rejectFrom = (0 - intervalSize) % intervalSize;
+        uint64_t raw;
+        uint32_t halves[2];
+        do {
+            prng.fill(halves, 2);
+            raw = (static_cast<uint64_t>(halves[0]) << 32) | halves[1];
+        } while (raw < rejectFrom);
+        return 2 + raw % intervalSize;
+    }
+
+    /** Witness da rodada  round  segundo witnessMode() para n ≥ 2⁶⁴ (toda
+        base < 2⁶⁴ cabe em [2, n-2]). FixedBases passa a Small64 depois
+        da 64ª rodada. */
+    void nextWitness(const BigInt& modulusUnderTest, int round, PRNG& prng, BigInt& witness)
+    {
+        switch (witnessMode_)
         {
-            uint32_t prngChunk = prng.generate();
-            unsigned bitsToTake =
-                std::min(bitsPerPRNGCall, requiredBits - bitsCollected);
-            uint32_t mask =
-                (bitsToTake == 32) ? 0xFFFFFFFFu : ((1u << bitsToTake) - 1u);
-            rawRandomValue |= BigInt(prngChunk & mask) << bitsCollected;
-            bitsCollected  += bitsToTake;
+        case WitnessMode::FixedBases:
+            if (round >= 0 && static_cast<std::size_t>(round) < FIXED_BASES.size())
+            {
+                witness = FIXED_BASES[static_cast<std::size_t>(round)];
+                return;
+            }
+            [[fallthrough]];
+        case WitnessMode::Small64:
+            witness = smallWitness(prng);
+            return;
+        case WitnessMode::FullRange:
+            generateWitness(modulusUnderTest, prng, witness);
+            return;
         }
-        /* Mapear para [2, modulus-2] */
-        return 2 + (rawRandomValue % intervalSize);
+    }
+
+    /** Idem para 3 < n < 2⁶⁴ (bases fixas ≥ n-1 passam a aleatórias). */
+    uint64_t nextWitness(uint64_t modulusUnderTest, int round, PRNG& prng)
+    {
+        if (witnessMode_ == WitnessMode::FixedBases && round >= 0 &&
+            static_cast<std::size_t>(round) < FIXED_BASES.size() &&
+            FIXED_BASES[static_cast<std::size_t>(round)] < modulusUnderTest - 1)
+            return FIXED_BASES[static_cast<std::size_t>(round)];
+        return generateWitness(modulusUnderTest, prng);
     }
 
     /** Decompõe  n-1 = oddComponent · 2^powerOfTwoExponent,  oddComponent ímpar. */
@@ -54,7 +126,13 @@ protected:
 public:
     virtual ~PrimalityTest() = default;
 
+    void setWitnessMode(WitnessMode mode) noexcept { witnessMode_ = mode; }
+    [[nodiscard]] WitnessMode witnessMode() const noexcept { return witnessMode_; }
+
+    /** Com  cancel  sinalizado, retorna false assim que possível
+        (entre rodadas ou no meio de uma exponenciação). */
     virtual bool isPrime(const BigInt& modulusUnderTest,
                          int           witnessIterations,
-                         PRNG&         randomGenerator) = 0;
+                         PRNG&         randomGenerator,
+                         const CancellationToken& cancel = CancellationToken{}) = 0;
 };
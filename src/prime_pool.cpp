@@ -0,0 +1,279 @@
+/*──────────────────────────────────────────────────────────────
+ *  PrimePool  –  reservatórios de primos em segundo plano.
+ *──────────────────────────────────────────────────────────────*/
+#include "prime_pool.h"
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+std::size_t nextPowerOfTwo(std::size_t value) noexcept
+{
+    std::size_t power = 1;
+    while (power < value) power <<= 1;
+    return power;
+}
+
+/* Melhor esforço: sem SCHED_IDLE o worker só segue na prioridade normal */
+void lowerToIdlePriority() noexcept
+{
+#if defined(__linux__)
+    sched_param parameters {};
+    pthread_setschedparam(pthread_self(), SCHED_IDLE, &parameters);
+#endif
+}
+} // namespace
+
+/*──────────── Anel do reservatório ────────────*/
+
+bool PrimePool::Reservoir::push(uint64_t offset)
+{
+    std::lock_guard<std::mutex> lock(pushMutex);
+    const uint64_t position = tail.load(std::memory_order_relaxed);
+    if (position - head.load(std::memory_order_acquire) >= capacity) return false;
+    slots[position & (capacity - 1)].store(offset, std::memory_order_relaxed);
+    tail.store(position + 1, std::memory_order_release);
+    return true;
+}
+
+std::optional<uint64_t> PrimePool::Reservoir::pop() noexcept
+{
+    uint64_t position = head.load(std::memory_order_acquire);
+    for (;;)
+    {
+        if (position == tail.load(std::memory_order_acquire)) return std::nullopt;
+        const uint64_t offset = slots[position & (capacity - 1)].load(std::memory_order_relaxed);
+        if (head.compare_exchange_weak(position, position + 1, std::memory_order_acq_rel,
+                                       std::memory_order_acquire))
+            return offset;
+    }
+}
+
+/*──────────── PrimePool ────────────*/
+
+PrimePool::PrimePool(std::unique_ptr<PRNG> prng,
+                     PrimalityTest*        tester,
+                     const std::string&    storePath,
+                     unsigned              workerCount,
+                     int                   primalityIter)
+    : prng_(std::move(prng)),
+      tester_(tester),
+      primalityIterations_(primalityIter),
+      workerCount_(std::max(workerCount, 1u)),
+      store_(storePath)
+{
+    if (!prng_ || !tester_)
+        throw std::invalid_argument("Null pointer");
+    if (primalityIterations_ <= 0)
+        throw std::invalid_argument("Iterations must be positive");
+}
+
+PrimePool::~PrimePool()
+{
+    try {
+        stop();
+    } catch (...) {
+        // flush final falhou; os registros seguem no cache de páginas
+    }
+}
+
+void PrimePool::addBitSize(unsigned bits, std::size_t lowWatermark, std::size_t highWatermark)
+{
+    if (!workers_.empty())
+        throw std::logic_error("PrimePool: addBitSize after start()");
+    if (bits < 2)
+        throw std::invalid_argument("bits must be ≥ 2");
+    if (lowWatermark >= highWatermark)
+        throw std::invalid_argument("lowWatermark must be below highWatermark");
+    if (reservoirs_.count(bits))
+        throw std::invalid_argument("bit size already registered");
+
+    std::vector<uint64_t> recovered;
+    for (const PrimeStore::Record& record : store_.recovered())
+        if (record.bits == bits) recovered.push_back(record.offset);
+
+    auto reservoir = std::make_unique<Reservoir>();
+    reservoir->bits          = bits;
+    reservoir->lowWatermark  = lowWatermark;
+    reservoir->highWatermark = highWatermark;
+    // Os workers não passam da marca alta (pending); só o que veio do arquivo pode
+    reservoir->capacity      = nextPowerOfTwo(std::max(highWatermark, recovered.size()));
+    reservoir->slots         = std::make_unique<std::atomic<uint64_t>[]>(reservoir->capacity);
+    for (uint64_t offset : recovered) reservoir->push(offset);
+
+    reservoirs_.emplace(bits, std::move(reservoir));
+}
+
+void PrimePool::start()
+{
+    if (!workers_.empty()) return;
+    stopping_.store(false);
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex_);
+        for (auto& entry : reservoirs_)
+        {
+            Reservoir& reservoir = *entry.second;
+            reservoir.refilling.store(reservoir.size() < reservoir.highWatermark);
+        }
+    }
+    for (unsigned i = 0; i < workerCount_; ++i)
+        workers_.emplace_back([this] { workerLoop(); });
+}
+
+void PrimePool::stop()
+{
+    if (workers_.empty()) return;
+    stopping_.store(true);                               // as buscas em curso observam
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex_);
+        wakeUp_.notify_all();
+    }
+    for (auto& worker : workers_) worker.join();
+    workers_.clear();
+    store_.flush();
+}
+
+PrimePool::Reservoir& PrimePool::reservoirFor(unsigned bits) const
+{
+    auto it = reservoirs_.find(bits);
+    if (it == reservoirs_.end())
+        throw std::invalid_argument("bit size not registered in the prime pool");
+    return *it->second;
+}
+
+std::optional<BigInt> PrimePool::tryTake(unsigned bits)
+{
+    Reservoir& reservoir = reservoirFor(bits);
+    while (const std::optional<uint64_t> offset = reservoir.pop())
+    {
+        /* O anel já garante um consumidor por slot; o CAS no arquivo torna a
+           entrega definitiva (um registro TAKEN não volta na reabertura) */
+        if (!store_.claim(*offset)) continue;
+
+        if (reservoir.size() <= reservoir.lowWatermark && !reservoir.refilling.exchange(true))
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex_);
+            wakeUp_.notify_all();
+        }
+        return store_.read(*offset);
+    }
+    return std::nullopt;
+}
+
+BigInt PrimePool::take(unsigned bits)
+{
+    if (std::optional<BigInt> prime = tryTake(bits)) return std::move(*prime);
+
+    Reservoir& reservoir = reservoirFor(bits);
+    std::lock_guard<std::mutex> lock(reservoir.fallbackMutex);
+    if (!reservoir.fallback)
+        reservoir.fallback = std::make_unique<KeyGenerator>(prng_->clone(), tester_, bits,
+                                                            primalityIterations_);
+    return reservoir.fallback->generateKeyConcurrent(std::random_device{}());
+}
+
+std::size_t PrimePool::available(unsigned bits) const
+{
+    return reservoirFor(bits).size();
+}
+
+bool PrimePool::waitUntilFull(std::chrono::milliseconds timeout)
+{
+    auto allFull = [this]
+    {
+        return std::all_of(reservoirs_.begin(), reservoirs_.end(), [](const auto& entry)
+        {
+            return entry.second->size() >= entry.second->highWatermark;
+        });
+    };
+    std::unique_lock<std::mutex> lock(wakeMutex_);
+    filled_.wait_for(lock, timeout, [&] { return workerError_ || storeFull_ || allFull(); });
+    if (workerError_) std::rethrow_exception(workerError_);
+    return allFull();
+}
+
+PrimePool::Reservoir* PrimePool::nextToRefill() const
+{
+    if (storeFull_ || workerError_) return nullptr;
+
+    /* Menor fração da marca alta (contando as buscas em curso) primeiro */
+    Reservoir* chosen = nullptr;
+    double chosenFill = 1.0;
+    for (const auto& entry : reservoirs_)
+    {
+        Reservoir& reservoir = *entry.second;
+        if (!reservoir.refilling.load()) continue;
+        const double fill = static_cast<double>(reservoir.size() + reservoir.pending) /
+                            static_cast<double>(reservoir.highWatermark);
+        if (fill < chosenFill)
+        {
+            chosen = &reservoir;
+            chosenFill = fill;
+        }
+    }
+    return chosen;
+}
+
+void PrimePool::workerLoop()
+{
+    lowerToIdlePriority();
+
+    /* Um gerador por tamanho, semeado uma vez: os primos seguintes
+       continuam o fluxo (generateKeyFromStream), sem repetir sementes */
+    std::map<unsigned, std::unique_ptr<KeyGenerator>> generators;
+
+    std::unique_lock<std::mutex> lock(wakeMutex_);
+    while (!stopping_.load())
+    {
+        Reservoir* reservoir = nextToRefill();
+        if (!reservoir)
+        {
+            wakeUp_.wait(lock);
+            continue;
+        }
+        ++reservoir->pending;
+        lock.unlock();
+
+        bool storeFull = false;
+        std::exception_ptr error;
+        try {
+            std::unique_ptr<KeyGenerator>& generator = generators[reservoir->bits];
+            if (!generator)
+            {
+                std::unique_ptr<PRNG> prng = prng_->clone();
+                prng->setSeed(std::random_device{}());
+                generator = std::make_unique<KeyGenerator>(std::move(prng), tester_, reservoir->bits,
+                                                           primalityIterations_);
+            }
+            BigInt prime;
+            if (generator->generateKeyFromStream(stopping_, prime))
+            {
+                const std::optional<uint64_t> offset = store_.append(prime);
+                if (!offset)
+                    storeFull = true;
+                else if (reservoir->push(*offset) &&
+                         reservoir->size() >= reservoir->highWatermark)
+                    store_.flush();                      // fim da recarga: lote no disco
+            }
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        lock.lock();
+        --reservoir->pending;
+        if (storeFull) storeFull_ = true;
+        if (error && !workerError_) workerError_ = error;
+        if (reservoir->size() >= reservoir->highWatermark)
+        {
+            reservoir->refilling.store(false);
+            /* Um consumidor pode ter cruzado a marca baixa enquanto o flag
+               ainda era true (e não acordou ninguém): retoma aqui */
+            if (reservoir->size() <= reservoir->lowWatermark) reservoir->refilling.store(true);
+        }
+        filled_.notify_all();
+    }
+}
@@ -0,0 +1,118 @@
+// prime_pool.h
+#pragma once
+/*──────────────────────────────────────────────────────────────
+ *  PrimePool  –  reservatórios de primos prontos por tamanho,
+ *  enchidos em segundo plano e persistidos num PrimeStore.
+ *
+ *  Cada tamanho registrado (addBitSize) tem marcas baixa e alta: quando
+ *  o estoque chega à baixa, os workers de fundo geram primos até a alta
+ *  e param. Os workers rodam em SCHED_IDLE (Linux): só usam CPU que
+ *  ninguém mais quer, e a geração migra para os períodos ociosos.
+ *
+ *  O pedido (tryTake) não gera nada: retira o offset de um anel com um
+ *  CAS no índice de leitura e marca o registro TAKEN no arquivo — cada
+ *  primo sai uma única vez, também entre reinícios, e os READY do
+ *  arquivo voltam aos reservatórios quando o pool reabre.
+ *──────────────────────────────────────────────────────────────*/
+#include "key_generator.h"
+#include "prime_store.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+class PrimePool
+{
+public:
+    /** Os workers geram com clones de  prng  (semeados de std::random_device)
+        e  tester; o arquivo em  storePath  é aberto (ou criado) aqui. */
+    PrimePool(std::unique_ptr<PRNG> prng,
+              PrimalityTest* tester,
+              const std::string& storePath,
+              unsigned workerCount = 1,
+              int primalityIter = 64);
+    ~PrimePool();                                        // stop()
+
+    PrimePool(const PrimePool&) = delete;
+    PrimePool& operator=(const PrimePool&) = delete;
+
+    /** Registra um tamanho (antes de start); os primos READY desse tamanho
+        no arquivo entram no reservatório na hora. */
+    void addBitSize(unsigned bits, std::size_t lowWatermark, std::size_t highWatermark);
+    /** Inicia os workers; reservatórios abaixo da marca alta já enchem. */
+    void start();
+    /** Interrompe as buscas em curso, junta os workers e faz flush do arquivo. */
+    void stop();
+
+    /** Primo pronto de  bits  bits, ou nullopt se o reservatório estiver vazio.
+        Sem lock; só acorda os workers ao cruzar a marca baixa. */
+    [[nodiscard]] std::optional<BigInt> tryTake(unsigned bits);
+    /** tryTake ou, com o reservatório vazio, uma busca concorrente na hora. */
+    [[nodiscard]] BigInt take(unsigned bits);
+
+    [[nodiscard]] std::size_t available(unsigned bits) const;
+    /** Espera todos os reservatórios chegarem à marca alta; false se o
+        arquivo encher ou  timeout  vencer antes. Um erro de worker (que
+        encerra a produção) é relançado aqui. */
+    bool waitUntilFull(std::chrono::milliseconds timeout);
+
+    [[nodiscard]] PrimeStore& store() noexcept { return store_; }
+
+private:
+    /* Anel de offsets: um produtor por vez (pushMutex), consumidores por
+       CAS em head. Um slot só é reescrito depois que head passou dele, e
+       o CAS de quem o leu falha nesse caso — o valor lido é sempre válido. */
+    struct Reservoir
+    {
+        unsigned    bits;
+        std::size_t lowWatermark;
+        std::size_t highWatermark;
+        std::size_t capacity;                            // potência de 2
+        std::unique_ptr<std::atomic<uint64_t>[]> slots;
+
+        alignas(64) std::atomic<uint64_t> head {0};      // consumidores
+        alignas(64) std::atomic<uint64_t> tail {0};      // produtor
+        std::mutex        pushMutex;
+        std::atomic<bool> refilling {false};             // entre baixa e alta
+        unsigned          pending   {0};                 // buscas em curso (sob wakeMutex_)
+
+        std::mutex                    fallbackMutex;     // gerador de take()
+        std::unique_ptr<KeyGenerator> fallback;
+
+        [[nodiscard]] std::size_t size() const noexcept
+        {
+            const uint64_t first = head.load(std::memory_order_acquire);   // antes de tail:
+            return static_cast<std::size_t>(tail.load(std::memory_order_acquire) - first);  // nunca < 0
+        }
+        bool push(uint64_t offset);
+        std::optional<uint64_t> pop() noexcept;
+    };
+
+    Reservoir& reservoirFor(unsigned bits) const;
+    // Reservatório em recarga com mais espaço livre (sob wakeMutex_)
+    Reservoir* nextToRefill() const;
+    void workerLoop();
+
+    std::unique_ptr<PRNG> prng_;
+    PrimalityTest*        tester_;
+    int                   primalityIterations_;
+    unsigned              workerCount_;
+    PrimeStore            store_;
+
+    std::map<unsigned, std::unique_ptr<Reservoir>> reservoirs_;  // fixo após start()
+    std::vector<std::thread> workers_;
+    std::atomic<bool>        stopping_ {false};
+    bool                     storeFull_ {false};         // sob wakeMutex_
+    std::exception_ptr       workerError_;               // 1º erro de um worker (idem)
+    mutable std::mutex       wakeMutex_;
+    std::condition_variable  wakeUp_;                    // recarga pedida ou stop
+    std::condition_variable  filled_;                    // um primo novo entrou
+};
@@ -0,0 +1,291 @@
+/*──────────────────────────────────────────────────────────────
+ *  PrimeStore  –  arquivo de primos mapeado em memória.
+ *──────────────────────────────────────────────────────────────*/
+#include "prime_store.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+constexpr char     STORE_MAGIC[8]     = {'P', 'R', 'M', 'S', 'T', 'O', 'R', 'E'};
+constexpr uint32_t STORE_VERSION      = 1;
+constexpr uint64_t HEADER_BYTES       = 64;
+constexpr uint64_t VERSION_OFFSET     = 8;
+constexpr uint64_t USED_BYTES_OFFSET  = 16;
+constexpr uint64_t RECORD_HEADER_BYTES = 8;   // state | bits | limbCount
+constexpr uint64_t COMPACT_MIN_BYTES  = PrimeStore::GROWTH_BYTES;
+
+/* Estados do registro (0 nunca é publicado: lixo de um append interrompido) */
+constexpr uint32_t RECORD_READY = 1;
+constexpr uint32_t RECORD_TAKEN = 2;
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free && sizeof(std::atomic<uint32_t>) == 4);
+static_assert(std::atomic<uint64_t>::is_always_lock_free && sizeof(std::atomic<uint64_t>) == 8);
+
+/* Campos compartilhados entre threads são lidos/escritos como atômicos no mapeamento */
+template <class T>
+std::atomic<T>& atomicAt(unsigned char* address) noexcept
+{
+    return *reinterpret_cast<std::atomic<T>*>(address);
+}
+
+uint16_t loadField16(const unsigned char* address) noexcept
+{
+    uint16_t value;
+    std::memcpy(&value, address, sizeof value);
+    return value;
+}
+
+void storeField16(unsigned char* address, uint16_t value) noexcept
+{
+    std::memcpy(address, &value, sizeof value);
+}
+
+constexpr uint64_t recordBytesFor(uint64_t limbCount) noexcept
+{
+    return RECORD_HEADER_BYTES + 8 * limbCount;
+}
+
+constexpr std::size_t roundUp(std::size_t bytes, std::size_t step) noexcept
+{
+    return (bytes + step - 1) / step * step;
+}
+
+[[noreturn]] void throwSystemError(const std::string& what)
+{
+    throw std::system_error(errno, std::generic_category(), "PrimeStore: " + what);
+}
+
+/* Reserva sem memória nem arquivo por trás: só fixa o endereço */
+void* reserveAddressSpace(void* address, std::size_t bytes) noexcept
+{
+    const int fixed = address ? MAP_FIXED : 0;
+    return ::mmap(address, bytes, PROT_NONE,
+                  MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | fixed, -1, 0);
+}
+} // namespace
+
+PrimeStore::PrimeStore(const std::string& path, std::size_t maxBytes)
+    : path_(path),
+      maxBytes_(maxBytes / GROWTH_BYTES * GROWTH_BYTES)
+{
+    if (maxBytes_ == 0)
+        throw std::invalid_argument("maxBytes must be at least GROWTH_BYTES");
+
+    void* reservation = reserveAddressSpace(nullptr, maxBytes_);
+    if (reservation == MAP_FAILED) throwSystemError("mmap (reserve)");
+    base_ = static_cast<unsigned char*>(reservation);
+
+    try {
+        fileDescriptor_ = openLocked(path_, 0);
+        mapFile();
+        const uint64_t takenBytes = scan();
+        if (takenBytes >= COMPACT_MIN_BYTES && takenBytes * 2 > usedBytes() - HEADER_BYTES)
+        {
+            compact();
+            scan();
+        }
+    } catch (...) {
+        ::munmap(base_, maxBytes_);
+        if (fileDescriptor_ >= 0) ::close(fileDescriptor_);
+        throw;
+    }
+}
+
+PrimeStore::~PrimeStore()
+{
+    ::munmap(base_, maxBytes_);        // reserva e trechos do arquivo
+    ::close(fileDescriptor_);          // libera o flock
+}
+
+int PrimeStore::openLocked(const std::string& path, int extraFlags)
+{
+    const int fileDescriptor = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC | extraFlags, 0644);
+    if (fileDescriptor < 0) throwSystemError("open " + path);
+    if (::flock(fileDescriptor, LOCK_EX | LOCK_NB) != 0)
+    {
+        const int error = errno;
+        ::close(fileDescriptor);
+        errno = error;
+        throwSystemError(path + " is in use");
+    }
+    return fileDescriptor;
+}
+
+void PrimeStore::mapFile()
+{
+    struct stat info {};
+    if (::fstat(fileDescriptor_, &info) != 0) throwSystemError("fstat");
+    const auto fileBytes = static_cast<std::size_t>(info.st_size);
+    if (fileBytes > maxBytes_)
+        throw std::runtime_error("PrimeStore: " + path_ + " is larger than maxBytes");
+
+    const bool fresh = fileBytes == 0;
+    grow(std::max<std::size_t>(fileBytes, HEADER_BYTES));   // arredonda para GROWTH_BYTES
+
+    if (fresh)
+    {
+        std::memcpy(base_, STORE_MAGIC, sizeof STORE_MAGIC);
+        std::memcpy(base_ + VERSION_OFFSET, &STORE_VERSION, sizeof STORE_VERSION);
+        atomicAt<uint64_t>(base_ + USED_BYTES_OFFSET).store(HEADER_BYTES, std::memory_order_release);
+        return;
+    }
+
+    uint32_t version;
+    std::memcpy(&version, base_ + VERSION_OFFSET, sizeof version);
+    const uint64_t used = usedBytes();
+    if (std::memcmp(base_, STORE_MAGIC, sizeof STORE_MAGIC) != 0 || version != STORE_VERSION ||
+        used < HEADER_BYTES || used > mappedBytes_)
+        throw std::runtime_error("PrimeStore: " + path_ + " is not a prime store");
+}
+
+uint64_t PrimeStore::scan()
+{
+    recovered_.clear();
+    uint64_t takenBytes = 0;
+    const uint64_t end = usedBytes();
+
+    for (uint64_t offset = HEADER_BYTES; offset < end;)
+    {
+        unsigned char* record = base_ + offset;
+        const uint32_t state      = atomicAt<uint32_t>(record).load(std::memory_order_relaxed);
+        const unsigned bits       = end - offset >= RECORD_HEADER_BYTES ? loadField16(record + 4) : 0;
+        const uint64_t limbCount  = end - offset >= RECORD_HEADER_BYTES ? loadField16(record + 6) : 0;
+        const uint64_t recordBytes = recordBytesFor(limbCount);
+
+        /* Tudo antes de usedBytes foi publicado inteiro: inconsistência aqui é corrupção */
+        if (bits == 0 || limbCount != (bits + 63) / 64 || recordBytes > end - offset ||
+            (state != RECORD_READY && state != RECORD_TAKEN))
+            throw std::runtime_error("PrimeStore: corrupt record in " + path_);
+
+        if (state == RECORD_READY) recovered_.push_back({offset, bits});
+        else                       takenBytes += recordBytes;
+        offset += recordBytes;
+    }
+    return takenBytes;
+}
+
+void PrimeStore::compact()
+{
+    /* Cabeçalho e registros READY num buffer; o arquivo novo só substitui
+       o antigo (rename) depois de fsync — uma queda no meio deixa o antigo */
+    std::vector<unsigned char> content(base_, base_ + HEADER_BYTES);
+    for (const Record& record : recovered_)
+    {
+        const unsigned char* source = base_ + record.offset;
+        content.insert(content.end(), source, source + recordBytesFor(loadField16(source + 6)));
+    }
+    const uint64_t used = content.size();
+    std::memcpy(content.data() + USED_BYTES_OFFSET, &used, sizeof used);
+    content.resize(roundUp(content.size(), GROWTH_BYTES));
+
+    const std::string temporaryPath = path_ + ".compact";
+    const int temporary = openLocked(temporaryPath, O_TRUNC);
+    try {
+        for (std::size_t done = 0; done < content.size();)
+        {
+            const ssize_t written = ::pwrite(temporary, content.data() + done, content.size() - done,
+                                             static_cast<off_t>(done));
+            if (written < 0)
+            {
+                if (errno == EINTR) continue;
+                throwSystemError("write " + temporaryPath);
+            }
+            done += static_cast<std::size_t>(written);
+        }
+        if (::fsync(temporary) != 0) throwSystemError("fsync " + temporaryPath);
+        if (::rename(temporaryPath.c_str(), path_.c_str()) != 0) throwSystemError("rename " + temporaryPath);
+    } catch (...) {
+        ::close(temporary);
+        ::unlink(temporaryPath.c_str());
+        throw;
+    }
+
+    unmapFile();
+    ::close(fileDescriptor_);
+    fileDescriptor_ = temporary;       // já com o flock
+    mapFile();
+}
+
+void PrimeStore::grow(std::size_t bytes)
+{
+    const std::size_t target = std::min(maxBytes_, roundUp(bytes, GROWTH_BYTES));
+    if (target <= mappedBytes_) return;
+
+    if (::ftruncate(fileDescriptor_, static_cast<off_t>(target)) != 0) throwSystemError("ftruncate");
+    /* Só o trecho novo, sobre a reserva: o que já está mapeado não se move */
+    void* mapped = ::mmap(base_ + mappedBytes_, target - mappedBytes_, PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_FIXED, fileDescriptor_, static_cast<off_t>(mappedBytes_));
+    if (mapped == MAP_FAILED) throwSystemError("mmap");
+    mappedBytes_ = target;
+}
+
+void PrimeStore::unmapFile() noexcept
+{
+    if (mappedBytes_ == 0) return;
+    reserveAddressSpace(base_, mappedBytes_);   // devolve o trecho à reserva
+    mappedBytes_ = 0;
+}
+
+std::optional<uint64_t> PrimeStore::append(const BigInt& prime)
+{
+    if (prime <= 0 || boost::multiprecision::msb(prime) >= 0xFFFF)
+        throw std::invalid_argument("prime must have 1 to 65535 bits");
+    const unsigned bits = static_cast<unsigned>(boost::multiprecision::msb(prime)) + 1;
+    const uint64_t limbCount = (bits + 63) / 64;
+    const uint64_t recordBytes = recordBytesFor(limbCount);
+
+    std::lock_guard<std::mutex> lock(appendMutex_);
+    const uint64_t offset = usedBytes();
+    if (offset + recordBytes > maxBytes_) return std::nullopt;
+    grow(offset + recordBytes);
+
+    /* Conteúdo primeiro; depois o estado e, por fim, o novo fim dos dados */
+    unsigned char* record = base_ + offset;
+    storeField16(record + 4, static_cast<uint16_t>(bits));
+    storeField16(record + 6, static_cast<uint16_t>(limbCount));
+    auto* limbs = reinterpret_cast<uint64_t*>(record + RECORD_HEADER_BYTES);
+    std::fill(limbs, limbs + limbCount, 0);
+    boost::multiprecision::export_bits(prime, limbs, 64, false);
+
+    atomicAt<uint32_t>(record).store(RECORD_READY, std::memory_order_release);
+    atomicAt<uint64_t>(base_ + USED_BYTES_OFFSET).store(offset + recordBytes, std::memory_order_release);
+    return offset;
+}
+
+bool PrimeStore::claim(uint64_t offset) noexcept
+{
+    uint32_t expected = RECORD_READY;
+    return atomicAt<uint32_t>(base_ + offset)
+        .compare_exchange_strong(expected, RECORD_TAKEN, std::memory_order_acq_rel,
+                                 std::memory_order_relaxed);
+}
+
+BigInt PrimeStore::read(uint64_t offset) const
+{
+    const unsigned char* record = base_ + offset;
+    const auto* limbs = reinterpret_cast<const uint64_t*>(record + RECORD_HEADER_BYTES);
+    BigInt prime;
+    boost::multiprecision::import_bits(prime, limbs, limbs + loadField16(record + 6), 64, false);
+    return prime;
+}
+
+void PrimeStore::flush()
+{
+    std::lock_guard<std::mutex> lock(appendMutex_);
+    if (::msync(base_, mappedBytes_, MS_SYNC) != 0) throwSystemError("msync");
+}
+
+uint64_t PrimeStore::usedBytes() const noexcept
+{
+    return atomicAt<uint64_t>(base_ + USED_BYTES_OFFSET).load(std::memory_order_acquire);
+}
@@ -0,0 +1,89 @@
+// prime_store.h
+#pragma once
+/*──────────────────────────────────────────────────────────────
+ *  PrimeStore  –  arquivo de primos mapeado em memória (append-only).
+ *
+ *  Layout: cabeçalho de 64 bytes e registros alinhados a 8 bytes:
+ *      uint32 state | uint16 bits | uint16 limbCount | limbs uint64 (LE)
+ *  O registro nasce READY e vira TAKEN por um CAS no próprio mapeamento
+ *  (MAP_SHARED): entregar um primo é uma escrita de 4 bytes, e quem
+ *  reabrir o arquivo só vê os primos ainda não entregues. O cabeçalho
+ *  publica o fim dos dados (usedBytes) só depois do registro completo:
+ *  um processo morto no meio de um append deixa lixo além de usedBytes,
+ *  ignorado na abertura.
+ *
+ *  O espaço de endereços (maxBytes) é reservado na abertura e o arquivo
+ *  cresce mapeando trechos novos dentro da reserva; a base nunca muda,
+ *  então leitores sem lock seguem válidos enquanto outra thread acrescenta.
+ *  Na abertura, se mais da metade dos dados for de registros TAKEN, o
+ *  arquivo é compactado (cópia dos vivos e rename atômico). Um flock
+ *  exclusivo impede que dois processos usem o mesmo arquivo.
+ *──────────────────────────────────────────────────────────────*/
+#include <boost/multiprecision/cpp_int.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+using BigInt = boost::multiprecision::cpp_int;
+
+class PrimeStore
+{
+public:
+    static constexpr std::size_t DEFAULT_MAX_BYTES = std::size_t{1} << 30;  // reserva de endereços
+    static constexpr std::size_t GROWTH_BYTES      = std::size_t{1} << 20;  // passo do arquivo
+
+    /* Registro READY: offset no arquivo e tamanho do primo em bits */
+    struct Record
+    {
+        uint64_t offset;
+        unsigned bits;
+    };
+
+    /** Abre (ou cria) o arquivo. Erros de sistema viram std::system_error
+        e um arquivo que não é um PrimeStore, std::runtime_error. */
+    explicit PrimeStore(const std::string& path, std::size_t maxBytes = DEFAULT_MAX_BYTES);
+    ~PrimeStore();
+
+    PrimeStore(const PrimeStore&) = delete;
+    PrimeStore& operator=(const PrimeStore&) = delete;
+
+    /** Registros READY encontrados na abertura, na ordem do arquivo. */
+    [[nodiscard]] const std::vector<Record>& recovered() const noexcept { return recovered_; }
+
+    /** Acrescenta  prime  (1 … 65535 bits) e devolve o offset do registro;
+        nullopt se o arquivo já ocupa maxBytes. Thread-safe. */
+    std::optional<uint64_t> append(const BigInt& prime);
+    /** READY → TAKEN. true só para quem ganhou o CAS; sem lock. */
+    [[nodiscard]] bool claim(uint64_t offset) noexcept;
+    /** Primo do registro em  offset  (de append ou de recovered). */
+    [[nodiscard]] BigInt read(uint64_t offset) const;
+    /** msync dos dados: persistência contra queda do sistema, não só do processo. */
+    void flush();
+
+    [[nodiscard]] uint64_t usedBytes() const noexcept;
+    [[nodiscard]] const std::string& path() const noexcept { return path_; }
+
+private:
+    // Abre o arquivo de  path  com flock exclusivo (sem esperar)
+    static int openLocked(const std::string& path, int extraFlags);
+    // Mapeia o arquivo e valida/inicializa o cabeçalho
+    void mapFile();
+    // Percorre os registros: preenche recovered_ e devolve os bytes TAKEN
+    uint64_t scan();
+    // Reescreve o arquivo só com os registros READY (ver cabeçalho)
+    void compact();
+    // Estende arquivo e mapeamento até pelo menos  bytes
+    void grow(std::size_t bytes);
+    void unmapFile() noexcept;
+
+    std::string          path_;
+    std::size_t          maxBytes_;
+    unsigned char*       base_ {nullptr};      // início da reserva de maxBytes_
+    std::size_t          mappedBytes_ {0};     // prefixo mapeado do arquivo
+    int                  fileDescriptor_ {-1};
+    std::mutex           appendMutex_;
+    std::vector<Record>  recovered_;
+};
@@ -1,7 +1,18 @@
 #include "pseudo_rng/chacha20_prng.h"
+#include "keygen_stats.h"
+#include <algorithm>
+#include <cstddef>
 #include <cstring>      // std::memcpy
 #include <stdexcept>
 
+/* Kernel AVX2 com despacho em tempo de execução (GCC/Clang, x86) */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#  define CHACHA20_HAS_AVX2_KERNEL 1
+#  include <immintrin.h>
+#else
+#  define CHACHA20_HAS_AVX2_KERNEL 0
+#endif
+
 /* ========================================================================
    Função utilitária: rotação esquerda de 32 bits
    ======================================================================== */
@@ -39,7 +50,7 @@ void ChaCha20PRNG::setSeed(uint_fast32_t newSeed)
 }
 
 /* -------------------------------------------------------------------------
-   Inicializa chave (256 bits) e nonce (96 bits) a partir da semente.
+   Inicializa chave (256 bits) e nonce (64 bits) a partir da semente.
    Estratégia simples: expande o seed usando um xorshift64.
    ------------------------------------------------------------------------- */
 void ChaCha20PRNG::initializeFromSeed(uint_fast32_t seedValue)
@@ -60,32 +71,19 @@ void ChaCha20PRNG::initializeFromSeed(uint_fast32_t seedValue)
 
     counterLow_ = 0;
     counterHigh_ = 0;
-    nextWordIndex_ = 16;           // invalida buffer atual
+    nextWordIndex_ = BUFFER_WORDS; // invalida buffer atual
     seed_ = seedValue;
 }
 
 /* -------------------------------------------------------------------------
-   Gera um bloco completo (16 words) – chamado quando buffer esgota
+   Um bloco: 20 rounds = 10 pares de (colunas + diagonais), soma a entrada
    ------------------------------------------------------------------------- */
-void ChaCha20PRNG::generateBlock()
+void ChaCha20PRNG::computeBlock(const uint32_t input[BLOCK_WORDS],
+                                uint32_t output[BLOCK_WORDS]) noexcept
 {
-    /* --- Estado inicial (16 words) --------------------------------------- */
-    uint32_t state[16] {
-        CONSTANT_WORDS_[0], CONSTANT_WORDS_[1],
-        CONSTANT_WORDS_[2], CONSTANT_WORDS_[3],
-
-        keyWords_[0], keyWords_[1], keyWords_[2], keyWords_[3],
-        keyWords_[4], keyWords_[5], keyWords_[6], keyWords_[7],
-
-        counterLow_, counterHigh_,                 // contador de 64 bits
-        nonceWords_[0], nonceWords_[1], nonceWords_[2]
-    };
+    uint32_t workingState[BLOCK_WORDS];
+    std::memcpy(workingState, input, sizeof(workingState));
 
-    /* --- Cópia para trabalhar --- */
-    uint32_t workingState[16];
-    std::memcpy(workingState, state, sizeof(state));
-
-    /* --- 20 rounds = 10 pares de (colunas + diagonais) ------------------- */
     for (int i = 0; i < 10; ++i) {
         /* Colunas */
         quarterRound(workingState[0],  workingState[4],
@@ -108,13 +106,164 @@ void ChaCha20PRNG::generateBlock()
                      workingState[9],  workingState[14]);
     }
 
-    /* --- Soma original + output e grava no buffer ------------------------ */
-    for (int i = 0; i < 16; ++i)
-        keystreamBlock_[i] = workingState[i] + state[i];
+    for (unsigned i = 0; i < BLOCK_WORDS; ++i)
+        output[i] = workingState[i] + input[i];
+}
+
+#if CHACHA20_HAS_AVX2_KERNEL
+/* -------------------------------------------------------------------------
+   Kernel AVX2: 8 blocos em paralelo, um por lane de 32 bits.
+   x[j] guarda a palavra j dos 8 blocos; o contador da lane i é c + i.
+   Compilado com target("avx2"): só é chamado se a CPU suportar.
+   ------------------------------------------------------------------------- */
+namespace {
+
+__attribute__((target("avx2")))
+inline __m256i rotateLeft(__m256i v, int shift) noexcept
+{
+    return _mm256_or_si256(_mm256_slli_epi32(v, shift), _mm256_srli_epi32(v, 32 - shift));
+}
+
+__attribute__((target("avx2")))
+inline void quarterRoundAvx2(__m256i& a, __m256i& b, __m256i& c, __m256i& d,
+                             __m256i rot16, __m256i rot8) noexcept
+{
+    a = _mm256_add_epi32(a, b); d = _mm256_xor_si256(d, a); d = _mm256_shuffle_epi8(d, rot16);
+    c = _mm256_add_epi32(c, d); b = _mm256_xor_si256(b, c); b = rotateLeft(b, 12);
+    a = _mm256_add_epi32(a, b); d = _mm256_xor_si256(d, a); d = _mm256_shuffle_epi8(d, rot8);
+    c = _mm256_add_epi32(c, d); b = _mm256_xor_si256(b, c); b = rotateLeft(b, 7);
+}
+
+/* Transpõe 8 vetores (palavra k de cada bloco) em 8 linhas (bloco r) */
+__attribute__((target("avx2")))
+inline void transposeStore(const __m256i words[8], uint32_t* out, std::size_t stride) noexcept
+{
+    const __m256i t0 = _mm256_unpacklo_epi32(words[0], words[1]);
+    const __m256i t1 = _mm256_unpackhi_epi32(words[0], words[1]);
+    const __m256i t2 = _mm256_unpacklo_epi32(words[2], words[3]);
+    const __m256i t3 = _mm256_unpackhi_epi32(words[2], words[3]);
+    const __m256i t4 = _mm256_unpacklo_epi32(words[4], words[5]);
+    const __m256i t5 = _mm256_unpackhi_epi32(words[4], words[5]);
+    const __m256i t6 = _mm256_unpacklo_epi32(words[6], words[7]);
+    const __m256i t7 = _mm256_unpackhi_epi32(words[6], words[7]);
+
+    const __m256i u0 = _mm256_unpacklo_epi64(t0, t2);
+    const __m256i u1 = _mm256_unpackhi_epi64(t0, t2);
+    const __m256i u2 = _mm256_unpacklo_epi64(t1, t3);
+    const __m256i u3 = _mm256_unpackhi_epi64(t1, t3);
+    const __m256i u4 = _mm256_unpacklo_epi64(t4, t6);
+    const __m256i u5 = _mm256_unpackhi_epi64(t4, t6);
+    const __m256i u6 = _mm256_unpacklo_epi64(t5, t7);
+    const __m256i u7 = _mm256_unpackhi_epi64(t5, t7);
+
+    auto row = [out, stride](unsigned r) {
+        return reinterpret_cast<__m256i*>(out + r * stride);
+    };
+    _mm256_storeu_si256(row(0), _mm256_permute2x128_si256(u0, u4, 0x20));
+    _mm256_storeu_si256(row(1), _mm256_permute2x128_si256(u1, u5, 0x20));
+    _mm256_storeu_si256(row(2), _mm256_permute2x128_si256(u2, u6, 0x20));
+    _mm256_storeu_si256(row(3), _mm256_permute2x128_si256(u3, u7, 0x20));
+    _mm256_storeu_si256(row(4), _mm256_permute2x128_si256(u0, u4, 0x31));
+    _mm256_storeu_si256(row(5), _mm256_permute2x128_si256(u1, u5, 0x31));
+    _mm256_storeu_si256(row(6), _mm256_permute2x128_si256(u2, u6, 0x31));
+    _mm256_storeu_si256(row(7), _mm256_permute2x128_si256(u3, u7, 0x31));
+}
+
+/* out: 8 blocos de 16 palavras (sem exigência de alinhamento) */
+__attribute__((target("avx2")))
+void eightBlocksAvx2(const uint32_t input[16], uint32_t* out) noexcept
+{
+    const __m256i rot16 = _mm256_setr_epi8(
+        2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13,
+        2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13);
+    const __m256i rot8 = _mm256_setr_epi8(
+        3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14,
+        3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14);
+
+    __m256i original[16];
+    for (unsigned j = 0; j < 16; ++j)
+        original[j] = _mm256_set1_epi32(static_cast<int>(input[j]));
+
+    /* Contador de 64 bits por lane: low + i, carry para a palavra alta */
+    const __m256i baseLow = original[12];
+    const __m256i low     = _mm256_add_epi32(baseLow, _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    const __m256i signBit = _mm256_set1_epi32(static_cast<int>(0x80000000u));
+    const __m256i wrapped = _mm256_cmpgt_epi32(_mm256_xor_si256(baseLow, signBit),
+                                               _mm256_xor_si256(low, signBit));
+    original[12] = low;
+    original[13] = _mm256_sub_epi32(original[13], wrapped);      // wrapped = -1 ⇒ +1
+
+    __m256i x[16];
+    for (unsigned j = 0; j < 16; ++j) x[j] = original[j];
+
+    for (int i = 0; i < 10; ++i) {
+        quarterRoundAvx2(x[0], x[4], x[8],  x[12], rot16, rot8);
+        quarterRoundAvx2(x[1], x[5], x[9],  x[13], rot16, rot8);
+        quarterRoundAvx2(x[2], x[6], x[10], x[14], rot16, rot8);
+        quarterRoundAvx2(x[3], x[7], x[11], x[15], rot16, rot8);
+
+        quarterRoundAvx2(x[0], x[5], x[10], x[15], rot16, rot8);
+        quarterRoundAvx2(x[1], x[6], x[11], x[12], rot16, rot8);
+        quarterRoundAvx2(x[2], x[7], x[8],  x[13], rot16, rot8);
+        quarterRoundAvx2(x[3], x[4], x[9],  x[14], rot16, rot8);
+    }
+    for (unsigned j = 0; j < 16; ++j) x[j] = _mm256_add_epi32(x[j], original[j]);
+
+    transposeStore(x,     out,     16);                  // palavras 0–7 de cada bloco
+    transposeStore(x + 8, out + 8, 16);                  // palavras 8–15
+}
+
+const bool cpuHasAvx2 = __builtin_cpu_supports("avx2");
+
+} // namespace
+
+bool ChaCha20PRNG::usesAvx2() noexcept { return cpuHasAvx2; }
+#else
+bool ChaCha20PRNG::usesAvx2() noexcept { return false; }
+#endif
+
+/* -------------------------------------------------------------------------
+   Gera BLOCKS_PER_REFILL blocos em  out  e avança o contador
+   ------------------------------------------------------------------------- */
+void ChaCha20PRNG::generateBlocks(uint32_t* out) noexcept
+{
+    /* --- Estado inicial (16 words) --------------------------------------- */
+    uint32_t state[BLOCK_WORDS] {
+        CONSTANT_WORDS_[0], CONSTANT_WORDS_[1],
+        CONSTANT_WORDS_[2], CONSTANT_WORDS_[3],
+
+        keyWords_[0], keyWords_[1], keyWords_[2], keyWords_[3],
+        keyWords_[4], keyWords_[5], keyWords_[6], keyWords_[7],
+
+        counterLow_, counterHigh_,                 // contador de 64 bits
+        nonceWords_[0], nonceWords_[1]
+    };
+
+#if CHACHA20_HAS_AVX2_KERNEL
+    if (cpuHasAvx2)
+        eightBlocksAvx2(state, out);
+    else
+#endif
+    {
+        for (unsigned block = 0; block < BLOCKS_PER_REFILL; ++block)
+        {
+            computeBlock(state, out + block * BLOCK_WORDS);
+            if (++state[12] == 0) ++state[13];
+        }
+    }
 
     /* --- Avança contador (64 bits) -------------------------------------- */
-    if (++counterLow_ == 0) ++counterHigh_;
+    const uint32_t previousLow = counterLow_;
+    counterLow_ += BLOCKS_PER_REFILL;
+    if (counterLow_ < previousLow) ++counterHigh_;
+}
 
+/* -------------------------------------------------------------------------
+   Recarrega o buffer – chamado quando ele esgota
+   ------------------------------------------------------------------------- */
+void ChaCha20PRNG::refillKeystream()
+{
+    generateBlocks(keystreamBuffer_.data());
     nextWordIndex_ = 0;
 }
 
@@ -123,7 +272,56 @@ void ChaCha20PRNG::generateBlock()
    ------------------------------------------------------------------------- */
 uint_fast32_t ChaCha20PRNG::generate()
 {
-    if (nextWordIndex_ >= 16) generateBlock();
-    return keystreamBlock_[nextWordIndex_++];
+    keygen_stats::add(&KeyGenerationStats::prngWords);
+    if (nextWordIndex_ >= BUFFER_WORDS) refillKeystream();
+    return keystreamBuffer_[nextWordIndex_++];
+}
+
+/* -------------------------------------------------------------------------
+   Preenchimento em bloco: esvazia o buffer, escreve lotes inteiros de
+   BLOCKS_PER_REFILL blocos direto no destino e completa pelo buffer
+   ------------------------------------------------------------------------- */
+void ChaCha20PRNG::fill(uint32_t* out, std::size_t count)
+{
+    keygen_stats::add(&KeyGenerationStats::prngWords, count);
+    const std::size_t buffered =
+        std::min<std::size_t>(count, BUFFER_WORDS - nextWordIndex_);
+    std::memcpy(out, keystreamBuffer_.data() + nextWordIndex_, buffered * sizeof(uint32_t));
+    nextWordIndex_ += static_cast<unsigned>(buffered);
+    out   += buffered;
+    count -= buffered;
+
+    for (; count >= BUFFER_WORDS; count -= BUFFER_WORDS, out += BUFFER_WORDS)
+        generateBlocks(out);
+
+    if (count > 0)
+    {
+        refillKeystream();
+        std::memcpy(out, keystreamBuffer_.data(), count * sizeof(uint32_t));
+        nextWordIndex_ = static_cast<unsigned>(count);
+    }
+}
+
+/* -------------------------------------------------------------------------
+   Salto: esvazia o buffer e soma os blocos inteiros ao contador de 64 bits;
+   o resto (< 1 bloco) sai do próximo lote
+   ------------------------------------------------------------------------- */
+void ChaCha20PRNG::discard(uint64_t count)
+{
+    const uint64_t buffered = BUFFER_WORDS - nextWordIndex_;
+    if (count <= buffered)
+    {
+        nextWordIndex_ += static_cast<unsigned>(count);
+        return;
+    }
+    count -= buffered;
+
+    const uint64_t counter = ((static_cast<uint64_t>(counterHigh_) << 32) | counterLow_)
+                           + count / BLOCK_WORDS;
+    counterLow_  = static_cast<uint32_t>(counter);
+    counterHigh_ = static_cast<uint32_t>(counter >> 32);
+
+    refillKeystream();
+    nextWordIndex_ = static_cast<unsigned>(count % BLOCK_WORDS);
 }
 
@@ -8,6 +8,11 @@
    -------------------------------------------------------------------------
    Implementa o gerador pseudo-aleatório baseado no stream-cipher ChaCha20.
    A cada chamada a generate() devolve 32 bits do keystream.
+
+   O keystream é produzido em lotes de BLOCKS_PER_REFILL blocos
+   consecutivos: com AVX2 (detectado em tempo de execução) os 8 blocos
+   saem juntos, um por lane; sem AVX2, um a um no caminho escalar. A
+   sequência gerada é a mesma nos dois caminhos.
    ========================================================================= */
 class ChaCha20PRNG final : public PRNG
 {
@@ -17,22 +22,31 @@ private:
         0x6170'7865u, 0x3320'646eu, 0x7962'2d32u, 0x6b20'6574u
     };
 
-    /* ---- Chave de 256 bits e nonce de 96 bits (RFC 8439) ---- */
+    /* ---- Chave de 256 bits e nonce de 64 bits (ChaCha original) ---- */
     std::array<uint32_t,8> keyWords_  {};   // k0…k7
-    std::array<uint32_t,3> nonceWords_{};   // n0…n2
+    std::array<uint32_t,2> nonceWords_{};   // n0…n1
 
     /* ---- Contador de 64 bits (split em 2 palavras) ---- */
     uint32_t counterLow_  {0};
     uint32_t counterHigh_ {0};
 
-    /* ---- Buffer com o bloco de 512 bits (16×32 bits) ---- */
-    std::array<uint32_t,16> keystreamBlock_ {};
-    unsigned nextWordIndex_ {16};           // 16 ⇒ força gerar bloco na 1ª chamada
+    /* ---- Buffer com BLOCKS_PER_REFILL blocos de 512 bits ---- */
+    static constexpr unsigned BLOCK_WORDS       = 16;
+    static constexpr unsigned BLOCKS_PER_REFILL = 8;
+    static constexpr unsigned BUFFER_WORDS      = BLOCK_WORDS * BLOCKS_PER_REFILL;
+    std::array<uint32_t,BUFFER_WORDS> keystreamBuffer_ {};
+    unsigned nextWordIndex_ {BUFFER_WORDS}; // cheio ⇒ força gerar na 1ª chamada
 
     /* ---------------------------------------------------------------------
-       Gera um bloco ChaCha20 (20 rounds) e preenche keystreamBlock_
+       Gera BLOCKS_PER_REFILL blocos (contadores c … c+7) e avança c;
+       refillKeystream() escreve no buffer, generateBlocks() em  out
        --------------------------------------------------------------------- */
-    void generateBlock();
+    void refillKeystream();
+    void generateBlocks(uint32_t* out) noexcept;
+
+    /* Um bloco ChaCha20 (20 rounds) a partir do estado de entrada */
+    static void computeBlock(const uint32_t input[BLOCK_WORDS],
+                             uint32_t output[BLOCK_WORDS]) noexcept;
 
     /* ---------------------------------------------------------------------
        Inicializa a chave/nonce a partir da semente fornecida.
@@ -50,9 +64,14 @@ public:
 
     [[nodiscard]] uint_fast32_t generate() override;
     void setSeed(uint_fast32_t newSeed) override;
+    void fill(uint32_t* out, std::size_t count) override;
+    void discard(uint64_t count) override;        // só avança o contador
 
     [[nodiscard]] std::unique_ptr<PRNG> clone() const override {
         return std::make_unique<ChaCha20PRNG>(*this);
     }
+
+    /// true se o kernel AVX2 de 8 blocos está em uso nesta CPU.
+    [[nodiscard]] static bool usesAvx2() noexcept;
 };
 
@@ -1,6 +1,12 @@
 // pseudo_rng/mersenne_twister.cpp
 #include "mersenne_twister.h"
+#include "keygen_stats.h"
+#include <algorithm>
+#include <array>
 #include <limits> // Para numeric_limits
+#include <mutex>
+#include <stdexcept>
+#include <vector>
 
 /* -------------------------------------------------------------------------
    Construtor: inicializa estado com a semente informada.
@@ -30,49 +36,449 @@ void MersenneTwister::setSeed(uint_fast32_t newSeed)
     index_ = STATE_SIZE; // Força twist() na próxima chamada a generate()
 }
 
-/* -------------------------------------------------------------------------
-   Gera novo bloco de 624 números (fase “twist” do MT).
-   Usa uint32_t para operações internas.
-   ------------------------------------------------------------------------- */
-void MersenneTwister::twist()
+/* =========================================================================
+   Twist sem módulo: para i < N-M  o termo distante é s[i+M] (ainda antigo);
+   para N-M ≤ i < N-1  é s[i-(N-M)], já atualizado neste twist, a uma
+   distância de N-M = 227 palavras — maior que qualquer vetor, então cada
+   segmento vetoriza sem dependência entre lanes. Só i = N-1 (que lê s[0]
+   novo) fica escalar.
+   ========================================================================= */
+namespace {
+
+constexpr unsigned N = 624;            // STATE_SIZE
+constexpr unsigned M = 397;            // TWIST_OFFSET
+constexpr uint32_t UPPER = 0x80000000u; // Bit mais significativo
+constexpr uint32_t LOWER = 0x7FFFFFFFu; // Bits menos significativos
+constexpr uint32_t A     = 0x9908B0DFu; // Matriz A de torção
+
+// Constantes de "tempering" (melhora distribuição)
+constexpr unsigned TEMPERING_SHIFT_U = 11;
+constexpr unsigned TEMPERING_SHIFT_S = 7;
+constexpr uint32_t TEMPERING_MASK_B  = 0x9D2C5680u;
+constexpr unsigned TEMPERING_SHIFT_T = 15;
+constexpr uint32_t TEMPERING_MASK_C  = 0xEFC60000u;
+constexpr unsigned TEMPERING_SHIFT_L = 18;
+
+inline uint32_t twistWord(uint32_t current, uint32_t next, uint32_t distant) noexcept
+{
+    const uint32_t merged = (current & UPPER) | (next & LOWER);
+    return distant ^ (merged >> 1) ^ ((0u - (merged & 1u)) & A);
+}
+
+/* s[i] ← twist(s[i], s[i+1]) ^ s[i+offset]  para i ∈ [begin, end) */
+inline void twistScalar(uint32_t* s, unsigned begin, unsigned end, int offset) noexcept
 {
-    for (unsigned i = 0; i < STATE_SIZE; ++i) {
-        // Combina bits superiores de state[i] com inferiores de state[(i+1) % N]
-        const uint32_t higherBits = stateVector_[i] & UPPER_MASK;
-        const uint32_t lowerBits  = stateVector_[(i + 1) % STATE_SIZE] & LOWER_MASK;
-        const uint32_t mergedBits = higherBits | lowerBits;
+    for (unsigned i = begin; i < end; ++i)
+        s[i] = twistWord(s[i], s[i + 1], s[static_cast<int>(i) + offset]);
+}
 
-        // Aplica a transformação linear (equivalente a multiplicar por A)
-        uint32_t temperedBits = mergedBits >> 1;
-        if (mergedBits & 1u) { // Se o bit menos significativo for 1
-            temperedBits ^= MATRIX_A; // XOR com a constante mágica A
-        }
+inline uint32_t temperWord(uint32_t y) noexcept
+{
+    y ^= y >> TEMPERING_SHIFT_U;
+    y ^= (y << TEMPERING_SHIFT_S) & TEMPERING_MASK_B;
+    y ^= (y << TEMPERING_SHIFT_T) & TEMPERING_MASK_C;
+    y ^= y >> TEMPERING_SHIFT_L;
+    return y;
+}
 
-        // Atualiza o estado usando o valor torcido e um elemento futuro
-        stateVector_[i] = stateVector_[(i + TWIST_OFFSET) % STATE_SIZE] ^ temperedBits;
+void twistAndTemperScalar(uint32_t* s, uint32_t* out) noexcept
+{
+    twistScalar(s, 0, N - M, static_cast<int>(M));
+    twistScalar(s, N - M, N - 1, -static_cast<int>(N - M));
+    s[N - 1] = twistWord(s[N - 1], s[0], s[M - 1]);
+    for (unsigned i = 0; i < N; ++i) out[i] = temperWord(s[i]);
+}
+
+} // namespace
+
+/* Kernels SIMD (GCC/Clang, x86): SSE2 é a base do x86-64; AVX2 é
+   compilado com target("avx2") e escolhido em tempo de execução */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#  define MT_HAS_SIMD_KERNELS 1
+#  include <immintrin.h>
+#else
+#  define MT_HAS_SIMD_KERNELS 0
+#endif
+
+#if MT_HAS_SIMD_KERNELS
+namespace {
+
+/* ---- SSE2: 4 palavras por passo ---- */
+__attribute__((target("sse2")))
+inline void twistSse2(uint32_t* s, unsigned begin, unsigned end, int offset) noexcept
+{
+    const __m128i upper = _mm_set1_epi32(static_cast<int>(UPPER));
+    const __m128i lower = _mm_set1_epi32(static_cast<int>(LOWER));
+    const __m128i a     = _mm_set1_epi32(static_cast<int>(A));
+    unsigned i = begin;
+    for (; i + 4 <= end; i += 4)
+    {
+        const __m128i current = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+        const __m128i next    = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i + 1));
+        const __m128i distant = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(s + static_cast<int>(i) + offset));
+        const __m128i merged  = _mm_or_si128(_mm_and_si128(current, upper),
+                                             _mm_and_si128(next, lower));
+        const __m128i odd     = _mm_srai_epi32(_mm_slli_epi32(merged, 31), 31); // 0 ou ~0
+        const __m128i result  = _mm_xor_si128(_mm_xor_si128(distant, _mm_srli_epi32(merged, 1)),
+                                              _mm_and_si128(odd, a));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(s + i), result);
     }
+    twistScalar(s, i, end, offset);
+}
+
+__attribute__((target("sse2")))
+void twistAndTemperSse2(uint32_t* s, uint32_t* out) noexcept
+{
+    twistSse2(s, 0, N - M, static_cast<int>(M));
+    twistSse2(s, N - M, N - 1, -static_cast<int>(N - M));
+    s[N - 1] = twistWord(s[N - 1], s[0], s[M - 1]);
+
+    const __m128i b = _mm_set1_epi32(static_cast<int>(TEMPERING_MASK_B));
+    const __m128i c = _mm_set1_epi32(static_cast<int>(TEMPERING_MASK_C));
+    for (unsigned i = 0; i < N; i += 4)                  // N múltiplo de 4
+    {
+        __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+        y = _mm_xor_si128(y, _mm_srli_epi32(y, TEMPERING_SHIFT_U));
+        y = _mm_xor_si128(y, _mm_and_si128(_mm_slli_epi32(y, TEMPERING_SHIFT_S), b));
+        y = _mm_xor_si128(y, _mm_and_si128(_mm_slli_epi32(y, TEMPERING_SHIFT_T), c));
+        y = _mm_xor_si128(y, _mm_srli_epi32(y, TEMPERING_SHIFT_L));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), y);
+    }
+}
+
+/* ---- AVX2: 8 palavras por passo ---- */
+__attribute__((target("avx2")))
+inline void twistAvx2(uint32_t* s, unsigned begin, unsigned end, int offset) noexcept
+{
+    const __m256i upper = _mm256_set1_epi32(static_cast<int>(UPPER));
+    const __m256i lower = _mm256_set1_epi32(static_cast<int>(LOWER));
+    const __m256i a     = _mm256_set1_epi32(static_cast<int>(A));
+    unsigned i = begin;
+    for (; i + 8 <= end; i += 8)
+    {
+        const __m256i current = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+        const __m256i next    = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i + 1));
+        const __m256i distant = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(s + static_cast<int>(i) + offset));
+        const __m256i merged  = _mm256_or_si256(_mm256_and_si256(current, upper),
+                                                _mm256_and_si256(next, lower));
+        const __m256i odd     = _mm256_srai_epi32(_mm256_slli_epi32(merged, 31), 31);
+        const __m256i result  = _mm256_xor_si256(
+            _mm256_xor_si256(distant, _mm256_srli_epi32(merged, 1)),
+            _mm256_and_si256(odd, a));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(s + i), result);
+    }
+    twistScalar(s, i, end, offset);
+}
+
+__attribute__((target("avx2")))
+void twistAndTemperAvx2(uint32_t* s, uint32_t* out) noexcept
+{
+    twistAvx2(s, 0, N - M, static_cast<int>(M));
+    twistAvx2(s, N - M, N - 1, -static_cast<int>(N - M));
+    s[N - 1] = twistWord(s[N - 1], s[0], s[M - 1]);
+
+    const __m256i b = _mm256_set1_epi32(static_cast<int>(TEMPERING_MASK_B));
+    const __m256i c = _mm256_set1_epi32(static_cast<int>(TEMPERING_MASK_C));
+    for (unsigned i = 0; i < N; i += 8)                  // N múltiplo de 8
+    {
+        __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+        y = _mm256_xor_si256(y, _mm256_srli_epi32(y, TEMPERING_SHIFT_U));
+        y = _mm256_xor_si256(y, _mm256_and_si256(_mm256_slli_epi32(y, TEMPERING_SHIFT_S), b));
+        y = _mm256_xor_si256(y, _mm256_and_si256(_mm256_slli_epi32(y, TEMPERING_SHIFT_T), c));
+        y = _mm256_xor_si256(y, _mm256_srli_epi32(y, TEMPERING_SHIFT_L));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), y);
+    }
+}
+
+const bool cpuHasSse2 = __builtin_cpu_supports("sse2");
+const bool cpuHasAvx2 = __builtin_cpu_supports("avx2");
+
+} // namespace
+
+bool MersenneTwister::usesAvx2() noexcept { return cpuHasAvx2; }
+#else
+bool MersenneTwister::usesAvx2() noexcept { return false; }
+#endif
+
+/* -------------------------------------------------------------------------
+   Gera novo bloco de 624 números (fase “twist” do MT) e o bloco de
+   saída correspondente, já com tempering.
+   ------------------------------------------------------------------------- */
+void MersenneTwister::twist()
+{
+    static_assert(STATE_SIZE == N && TWIST_OFFSET == M,
+                  "kernels assumem os parâmetros do MT19937");
+    uint32_t* state  = stateVector_.data();
+    uint32_t* output = outputBlock_.data();
+#if MT_HAS_SIMD_KERNELS
+    if (cpuHasAvx2)      twistAndTemperAvx2(state, output);
+    else if (cpuHasSse2) twistAndTemperSse2(state, output);
+    else
+#endif
+        twistAndTemperScalar(state, output);
     index_ = 0; // Reseta o índice para o início do novo bloco
 }
 
 /* -------------------------------------------------------------------------
    Devolve o próximo valor pseudo-aleatório (32 bits).
-   A interface ainda retorna uint_fast32_t, mas a geração interna é uint32_t.
+   O tempering já foi aplicado ao bloco inteiro em twist().
    ------------------------------------------------------------------------- */
 uint_fast32_t MersenneTwister::generate()
 {
+    keygen_stats::add(&KeyGenerationStats::prngWords);
     if (index_ >= STATE_SIZE) {
         // Se todos os números do bloco foram usados, gera um novo bloco
         twist();
     }
+    return static_cast<uint_fast32_t>(outputBlock_[index_++]);
+}
 
-    // Pega o próximo número do estado
-    uint32_t output = stateVector_[index_++]; // Usa uint32_t
+/* -------------------------------------------------------------------------
+   Preenchimento em bloco: copia o que resta do bloco de saída e, a cada
+   twist, até STATE_SIZE palavras de uma vez.
+   ------------------------------------------------------------------------- */
+void MersenneTwister::fill(uint32_t* out, std::size_t count)
+{
+    keygen_stats::add(&KeyGenerationStats::prngWords, count);
+    while (count > 0)
+    {
+        if (index_ >= STATE_SIZE) twist();
+        const std::size_t take = std::min<std::size_t>(count, STATE_SIZE - index_);
+        std::copy_n(outputBlock_.data() + index_, take, out);
+        index_ += static_cast<unsigned>(take);
+        out    += take;
+        count  -= take;
+    }
+}
+
+/* =========================================================================
+   Jump-ahead
+   -------------------------------------------------------------------------
+   O passo  T : (x_k … x_{k+623}) ↦ (x_{k+1} … x_{k+624})  é linear sobre
+   GF(2). Os 31 bits baixos de x_k não influenciam o futuro, então T age
+   num espaço de 19937 bits com polinômio característico φ (grau 19937)
+   e anula esses bits: T·φ(T) = 0. Logo, com  r = x^(J-1) mod φ,
+       T^J = T · r(T)      (exato, inclusive nos bits ignorados),
+   e r(T)·W = Σ rᵢ·Tⁱ·W  custa ≤ 19937 passos de uma palavra e ~10⁴ XORs
+   de janelas. φ sai de Berlekamp–Massey sobre 2·19937 bits da recorrência;
+   a tabela  x^(2^k - 1) mod φ  é preenchida sob demanda.
+   ========================================================================= */
+namespace {
 
-    // Aplica o "tempering" para melhorar a distribuição dos bits
-    output ^= (output >> TEMPERING_SHIFT_U); 
-    output ^= (output << TEMPERING_SHIFT_S) & TEMPERING_MASK_B;
-    output ^= (output << TEMPERING_SHIFT_T) & TEMPERING_MASK_C;
-    output ^= (output >> TEMPERING_SHIFT_L);
+constexpr unsigned DEGREE     = 32 * N - 31;             // 19937
+constexpr unsigned POLY_WORDS = DEGREE / 64 + 1;         // bits 0..DEGREE
+using Poly = std::vector<uint64_t>;
 
-    return static_cast<uint_fast32_t>(output);
+inline bool testBit(const Poly& p, unsigned bit) noexcept
+{
+    return (p[bit / 64] >> (bit % 64)) & 1u;
 }
+
+/* dst ^= src · x^shift  (dst precisa comportar o resultado) */
+void xorShifted(Poly& dst, const Poly& src, std::size_t srcWords, unsigned shift) noexcept
+{
+    const unsigned wordShift = shift / 64, bitShift = shift % 64;
+    for (std::size_t i = 0; i < srcWords; ++i)
+    {
+        dst[i + wordShift] ^= src[i] << bitShift;
+        if (bitShift && i + wordShift + 1 < dst.size())
+            dst[i + wordShift + 1] ^= src[i] >> (64 - bitShift);
+    }
+}
+
+/* Janela circular da recorrência: words[head] = x_k */
+struct Window
+{
+    std::array<uint32_t, N> words;
+    unsigned head {0};
+
+    void step() noexcept
+    {
+        const unsigned next    = head + 1 == N ? 0 : head + 1;
+        const unsigned distant = head + M < N ? head + M : head + M - N;
+        words[head] = twistWord(words[head], words[next], words[distant]);
+        head = next;
+    }
+    /* acc (alinhado: acc[j] = x_{k+j}) ^= janela */
+    void addTo(uint32_t* acc) const noexcept
+    {
+        for (unsigned j = 0; j < N - head; ++j) acc[j]            ^= words[head + j];
+        for (unsigned j = 0; j < head;     ++j) acc[N - head + j] ^= words[j];
+    }
+};
+
+/* Polinômio mínimo de  s  (Berlekamp–Massey sobre GF(2), em palavras).
+   Devolve φ com φ_j = C_{L-j}, C o polinômio de conexão. */
+Poly minimalPolynomial(const std::vector<uint8_t>& s, unsigned& degree)
+{
+    const std::size_t length = s.size();
+    const std::size_t words  = length / 64 + 2;
+
+    /* reversed[j] = s_{length-1-j}: a discrepância vira um AND de palavras */
+    Poly reversed(words + 1, 0);
+    for (std::size_t j = 0; j < length; ++j)
+        if (s[length - 1 - j]) reversed[j / 64] |= uint64_t(1) << (j % 64);
+    auto window64 = [&](std::size_t bit) {
+        const std::size_t w = bit / 64, b = bit % 64;
+        uint64_t value = w < reversed.size() ? reversed[w] >> b : 0;
+        if (b && w + 1 < reversed.size()) value |= reversed[w + 1] << (64 - b);
+        return value;
+    };
+
+    Poly connection(words, 0), previous(words, 0);
+    connection[0] = previous[0] = 1;
+    unsigned L = 0, gap = 1;
+    for (std::size_t n = 0; n < length; ++n)
+    {
+        /* d = Σ_{i=0..L} C_i · s_{n-i} */
+        const std::size_t offset = length - 1 - n;
+        uint64_t parity = 0;
+        for (std::size_t w = 0; w <= L / 64; ++w)
+            parity ^= connection[w] & window64(offset + 64 * w);
+        if (!__builtin_parityll(parity)) { ++gap; continue; }
+
+        if (2 * L <= n)
+        {
+            Poly saved = connection;
+            xorShifted(connection, previous, words - gap / 64 - 1, gap);
+            L = static_cast<unsigned>(n + 1 - L);
+            previous = std::move(saved);
+            gap = 1;
+        }
+        else
+        {
+            xorShifted(connection, previous, words - gap / 64 - 1, gap);
+            ++gap;
+        }
+    }
+
+    Poly phi(POLY_WORDS, 0);
+    for (unsigned j = 0; j <= L && j <= DEGREE; ++j)
+        if (testBit(connection, L - j)) phi[j / 64] |= uint64_t(1) << (j % 64);
+    degree = L;
+    return phi;
+}
+
+const Poly& characteristicPolynomial()
+{
+    static const Poly phi = [] {
+        /* Qualquer estado não nulo serve: φ é irredutível */
+        Window window;
+        for (unsigned i = 0; i < N; ++i) window.words[i] = 0x9E3779B9u * (i + 1);
+        std::vector<uint8_t> bits(2 * DEGREE);
+        for (auto& bit : bits) { bit = window.words[window.head] >> 31; window.step(); }
+
+        unsigned degree = 0;
+        Poly result = minimalPolynomial(bits, degree);
+        if (degree != DEGREE)
+            throw std::logic_error("MT19937: polinômio característico inesperado");
+        return result;
+    }();
+    return phi;
+}
+
+/* p mod φ, p com até 2·POLY_WORDS palavras */
+void reduce(Poly& p, const Poly& phi)
+{
+    for (unsigned bit = static_cast<unsigned>(p.size() * 64); bit-- > DEGREE;)
+        if (testBit(p, bit)) xorShifted(p, phi, POLY_WORDS, bit - DEGREE);
+    p.resize(POLY_WORDS);
+}
+
+/* x · r(x)² mod φ */
+Poly squareTimesX(const Poly& r, const Poly& phi)
+{
+    auto spread = [](uint32_t half) {                    // bits b → 2b
+        uint64_t v = half;
+        v = (v | (v << 16)) & 0x0000FFFF0000FFFFull;
+        v = (v | (v << 8))  & 0x00FF00FF00FF00FFull;
+        v = (v | (v << 4))  & 0x0F0F0F0F0F0F0F0Full;
+        v = (v | (v << 2))  & 0x3333333333333333ull;
+        v = (v | (v << 1))  & 0x5555555555555555ull;
+        return v;
+    };
+    Poly square(2 * POLY_WORDS + 1, 0);
+    for (unsigned i = 0; i < POLY_WORDS; ++i)
+    {
+        square[2 * i]     = spread(static_cast<uint32_t>(r[i]));
+        square[2 * i + 1] = spread(static_cast<uint32_t>(r[i] >> 32));
+    }
+    for (std::size_t i = square.size(); i-- > 1;)          // · x
+        square[i] = (square[i] << 1) | (square[i - 1] >> 63);
+    square[0] <<= 1;
+    reduce(square, phi);
+    return square;
+}
+
+/* x^(2^k - 1) mod φ, memorizado por k */
+const Poly& jumpPolynomial(unsigned log2Steps)
+{
+    static std::mutex mutex;
+    static std::array<Poly, 64> table;
+    static unsigned filled = 0;
+
+    const std::lock_guard<std::mutex> lock(mutex);
+    if (filled == 0)
+    {
+        table[0].assign(POLY_WORDS, 0);
+        table[0][0] = 1;                                     // x^0
+        filled = 1;
+    }
+    /* 2^k - 1 = 2·(2^(k-1) - 1) + 1 */
+    for (; filled <= log2Steps; ++filled)
+        table[filled] = squareTimesX(table[filled - 1], characteristicPolynomial());
+    return table[log2Steps];
+}
+
+/* state ← T^J · state, com  r = x^(J-1) mod φ */
+void applyJump(std::array<uint32_t, N>& state, const Poly& r) noexcept
+{
+    unsigned top = DEGREE;
+    while (top > 0 && !testBit(r, top - 1)) --top;       // grau de r + 1
+
+    Window window {state, 0};
+    std::array<uint32_t, N> acc {};
+    for (unsigned i = 0; i < top; ++i)
+    {
+        if (testBit(r, i)) window.addTo(acc.data());
+        if (i + 1 < top) window.step();
+    }
+
+    Window shifted {acc, 0};                             // o T final
+    shifted.step();
+    std::fill(state.begin(), state.end(), 0u);
+    shifted.addTo(state.data());
+}
+
+} // namespace
+
+/* -------------------------------------------------------------------------
+   Salto de 2^log2Steps palavras: a posição no bloco (index_) não muda;
+   o bloco inteiro avança e o tempering é refeito.
+   ------------------------------------------------------------------------- */
+void MersenneTwister::jump(unsigned log2Steps)
+{
+    if (log2Steps >= 64)
+        throw std::invalid_argument("log2Steps must be < 64");
+    applyJump(stateVector_, jumpPolynomial(log2Steps));
+    for (unsigned i = 0; i < STATE_SIZE; ++i) outputBlock_[i] = temperWord(stateVector_[i]);
+}
+
+void MersenneTwister::discard(uint64_t count)
+{
+    /* Abaixo de 2²² palavras (~6700 twists) andar é mais barato que saltar */
+    constexpr unsigned DIRECT_LOG2 = 22;
+    for (unsigned k = DIRECT_LOG2; k < 64; ++k)
+        if ((count >> k) & 1u) jump(k);
+    count &= (uint64_t(1) << DIRECT_LOG2) - 1;
+
+    while (count > STATE_SIZE - index_)
+    {
+        count -= STATE_SIZE - index_;
+        twist();
+    }
+    index_ += static_cast<unsigned>(count);
+}
+
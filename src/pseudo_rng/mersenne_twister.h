@@ -14,27 +14,18 @@ private:
     static constexpr unsigned WORD_SIZE          = 32;
     static constexpr unsigned STATE_SIZE         = 624;
     static constexpr unsigned TWIST_OFFSET       = 397;
-    static constexpr uint32_t MATRIX_A           = 0x9908B0DFu; // Matriz A de torção
-    static constexpr uint32_t UPPER_MASK         = 0x80000000u; // Bit mais significativo
-    static constexpr uint32_t LOWER_MASK         = 0x7FFFFFFFu; // Bits menos significativos
-
-    // Constantes de "tempering" (melhora distribuição)
-    static constexpr unsigned TEMPERING_SHIFT_U  = 11;
-    static constexpr uint32_t TEMPERING_MASK_D   = 0xFFFFFFFFu; 
-    static constexpr unsigned TEMPERING_SHIFT_S  = 7;
-    static constexpr uint32_t TEMPERING_MASK_B   = 0x9D2C5680u;
-    static constexpr unsigned TEMPERING_SHIFT_T  = 15;
-    static constexpr uint32_t TEMPERING_MASK_C   = 0xEFC60000u;
-    static constexpr unsigned TEMPERING_SHIFT_L  = 18;
+    // Máscaras, matriz A e constantes de tempering: ver mersenne_twister.cpp
 
     // Constante para semeadura
     static constexpr uint32_t SEED_MULTIPLIER    = 1812433253u;
 
     // Estado interno do gerador
     std::array<uint32_t, STATE_SIZE> stateVector_ {}; // Usa uint32_t explícito
-    unsigned index_ {STATE_SIZE};                      // Índice atual no vetor de estado, força twist() inicial
+    std::array<uint32_t, STATE_SIZE> outputBlock_ {}; // stateVector_ já com tempering
+    unsigned index_ {STATE_SIZE};                      // Índice atual no bloco de saída, força twist() inicial
 
-    // Função interna para gerar novos números no estado
+    // Gera o próximo estado e aplica o tempering ao bloco inteiro
+    // (SSE2/AVX2 quando disponíveis; mesma saída do laço escalar)
     void twist();
 
 public:
@@ -44,9 +35,26 @@ public:
     // Gera o próximo número pseudo-aleatório de 32 bits
     [[nodiscard]] uint_fast32_t generate() override;
 
+    // Copia blocos inteiros do estado (com tempering), um twist por bloco
+    void fill(uint32_t* out, std::size_t count) override;
+
+    // Avança  count  palavras (= count chamadas a generate()). A parte
+    // ≥ 2²² vai por saltos jump(k); o resto, por twists diretos.
+    void discard(uint64_t count) override;
+
+    // Avança exatamente 2^log2Steps palavras (log2Steps < 64) aplicando
+    // x^(2^k) mod φ(x) ao estado, φ o polinômio característico do MT19937.
+    // Custo ~constante (alguns ms); a 1ª chamada com cada k monta a tabela.
+    // Fluxos  base, base+2^k, base+2·2^k, ...  são disjuntos por construção
+    // enquanto cada um consumir menos de 2^k palavras.
+    void jump(unsigned log2Steps);
+
     // Define uma nova semente e reinicializa o estado
     void setSeed(uint_fast32_t newSeed) override;
 
+    /// true se twist/tempering usam o kernel AVX2 nesta CPU.
+    [[nodiscard]] static bool usesAvx2() noexcept;
+
     // Cria uma cópia do gerador (necessário para concorrência)
     [[nodiscard]] std::unique_ptr<PRNG> clone() const override {
         // Cria uma cópia exata, incluindo o estado atual e índice
@@ -4,82 +4,195 @@
  *  Fórmula original:
  *      f(x) = (g^{a₀})^{ Π_{i | xᵢ = 1} aᵢ }   (mod P)
  *
- *  • modulusP_         == P     (primo)
- *  • subgroupOrderQ_   == Q     (ordem do sub-grupo)
- *  • generatorG_       == g
+ *  • DEMO_MODULUS_P    == P     (primo)
+ *  • DEMO_SUBGROUP_Q   == Q     (ordem do sub-grupo)
+ *  • DEMO_GENERATOR_G  == g
  *  • fixedKeysA[i]     == aᵢ
  *
  *──────────────────────────────────────────────────────────────*/
 #include "naor_reingold_prf.h"
-#include <vector>
+#include "keygen_stats.h"
 #include <stdexcept>
 
 namespace {
 /* Parâmetros DiceForge */
-const BigInt DEMO_MODULUS_P("4279969613");
-const BigInt DEMO_SUBGROUP_Q("9999929");
-const BigInt DEMO_GENERATOR_G("9999918");
+constexpr uint64_t DEMO_MODULUS_P   = 4279969613u;
+constexpr uint64_t DEMO_SUBGROUP_Q  = 9999929u;
+constexpr uint64_t DEMO_GENERATOR_G = 9999918u;
 
 /* Chave fixa a₀ … a₃₂  (tamanho = INPUT_DIMENSION + 1) */
-const std::vector<BigInt> fixedKeysA = {
-    BigInt("650051"), BigInt("3948705"), BigInt("3142325"), BigInt("4036110"),
-    BigInt("1141941"), BigInt("5739231"), BigInt("5725758"), BigInt("8299330"),
-    BigInt("1776388"), BigInt("1423550"), BigInt("9260804"), BigInt("156410"),
-    BigInt("1190436"), BigInt("61218"),  BigInt("2382500"), BigInt("1738876"),
-    BigInt("7978879"), BigInt("6010478"), BigInt("310917"),  BigInt("4280253"),
-    BigInt("24724"),   BigInt("7087659"), BigInt("796099"),  BigInt("8383655"),
-    BigInt("7638286"), BigInt("1390415"), BigInt("7899225"), BigInt("5628976"),
-    BigInt("1472292"), BigInt("4284966"), BigInt("9708041"), BigInt("4179835"),
-    BigInt("3635954")
+constexpr std::array<uint64_t, 33> fixedKeysA = {
+    650051,  3948705, 3142325, 4036110,
+    1141941, 5739231, 5725758, 8299330,
+    1776388, 1423550, 9260804, 156410,
+    1190436, 61218,   2382500, 1738876,
+    7978879, 6010478, 310917,  4280253,
+    24724,   7087659, 796099,  8383655,
+    7638286, 1390415, 7899225, 5628976,
+    1472292, 4284966, 9708041, 4179835,
+    3635954
 };
+
+static_assert(DEMO_MODULUS_P < (uint64_t(1) << 32) && DEMO_SUBGROUP_Q < (uint64_t(1) << 24),
+              "aritmética nativa supõe P < 2³² e Q < 2²⁴");
+static_assert((DEMO_MODULUS_P - 1) % DEMO_SUBGROUP_Q == 0, "Q deve dividir P-1");
+
+/* Produtos de dois resíduos < 2³² cabem em 64 bits; P constante vira
+   multiplicação pelo inverso no compilador */
+constexpr uint64_t mulModP(uint64_t a, uint64_t b) noexcept { return a * b % DEMO_MODULUS_P; }
+constexpr uint64_t mulModQ(uint64_t a, uint64_t b) noexcept { return a * b % DEMO_SUBGROUP_Q; }
+
+/* (g^{a₀})^E  (mod P)  para E < Q < 2²⁴: três janelas de 8 bits,
+   table[w][j] = (g^{a₀})^{j·2^{8w}}  (mod P) */
+struct FixedBaseTables
+{
+    static constexpr unsigned WINDOW_BITS = 8;
+    static constexpr unsigned WINDOWS     = 3;
+    std::array<std::array<uint32_t, 1u << WINDOW_BITS>, WINDOWS> table;
+
+    FixedBaseTables() noexcept
+    {
+        /* Base g^{a₀} (mod P), calculada uma única vez */
+        uint64_t base = 1, square = DEMO_GENERATOR_G;
+        for (uint64_t e = fixedKeysA[0]; e; e >>= 1, square = mulModP(square, square))
+            if (e & 1) base = mulModP(base, square);
+
+        for (auto& window : table)
+        {
+            uint64_t power = 1;
+            for (auto& entry : window)
+            {
+                entry = static_cast<uint32_t>(power);
+                power = mulModP(power, base);
+            }
+            base = power;                                   // base^{2^8}
+        }
+    }
+
+    uint32_t power(uint64_t exponent) const noexcept
+    {
+        return static_cast<uint32_t>(mulModP(
+            mulModP(table[0][exponent & 0xFF], table[1][(exponent >> 8) & 0xFF]),
+            table[2][exponent >> 16]));
+    }
+};
+
+const FixedBaseTables& fixedBase()
+{
+    static const FixedBaseTables tables;
+    return tables;
+}
+
+/* Π_{i | jᵢ=1} a_{i+1}  (mod Q)  para os 256 valores do byte baixo de x */
+constexpr unsigned LOW_BITS = 8;
+const std::array<uint32_t, 1u << LOW_BITS>& lowSubsetProducts()
+{
+    static const auto products = [] {
+        std::array<uint32_t, 1u << LOW_BITS> table {};
+        table[0] = 1;
+        for (unsigned j = 1; j < table.size(); ++j)          // j sem o bit mais baixo
+            table[j] = static_cast<uint32_t>(mulModQ(table[j & (j - 1)],
+                                                     fixedKeysA[__builtin_ctz(j) + 1]));
+        return table;
+    }();
+    return products;
+}
 } // namespace
 
 NaorReingoldPRF::NaorReingoldPRF(uint_fast32_t initialSeed)
     : PRNG(initialSeed),
-      modulusP_(DEMO_MODULUS_P),
-      subgroupOrderQ_(DEMO_SUBGROUP_Q),
-      generatorG_(DEMO_GENERATOR_G),
-      inputVectorX_(initialSeed)
+      inputVectorX_(static_cast<uint32_t>(initialSeed))
 {
     /* Verifica se os parâmetros são válidos */
-
-    if ((modulusP_ - 1) % subgroupOrderQ_ != 0 ||
-        fixedKeysA.size() != INPUT_DIMENSION + 1)
+    if (fixedKeysA.size() != INPUT_DIMENSION + 1)
         throw std::runtime_error("Invalid Naor-Reingold parameters");
+    resetProducts();
 }
 
 void NaorReingoldPRF::setSeed(uint_fast32_t newSeed)
 {
     PRNG::setSeed(newSeed);
-    inputVectorX_ = newSeed;
+    inputVectorX_ = static_cast<uint32_t>(newSeed);
+    resetProducts();
+}
+
+void NaorReingoldPRF::resetProducts() noexcept
+{
+    suffixProduct_[INPUT_DIMENSION] = 1;
+    for (unsigned bit = INPUT_DIMENSION; bit-- > 0;)
+        suffixProduct_[bit] = ((inputVectorX_ >> bit) & 1u)
+            ? mulModQ(suffixProduct_[bit + 1], fixedKeysA[bit + 1])
+            : suffixProduct_[bit + 1];
+}
+
+uint32_t NaorReingoldPRF::evaluateAndAdvance() noexcept
+{
+    /* f(x) = (g^{a₀})^{Π_{i | xᵢ=1} aᵢ mod Q}  (mod P); 32 bits pois P < 2³² */
+    const uint32_t prfValue = fixedBase().power(suffixProduct_[0]);
+
+    /* x ← x+1: o bit do vai-um (carry) liga, os abaixo zeram */
+    ++inputVectorX_;
+    if (inputVectorX_ == 0)
+        suffixProduct_.fill(1);                          // volta a x ≡ 0 (mod 2³²)
+    else
+    {
+        const unsigned carry = static_cast<unsigned>(__builtin_ctz(inputVectorX_));
+        const uint64_t product = mulModQ(suffixProduct_[carry + 1], fixedKeysA[carry + 1]);
+        for (unsigned bit = 0; bit <= carry; ++bit) suffixProduct_[bit] = product;
+    }
+    return prfValue;
 }
 
 uint_fast32_t NaorReingoldPRF::generate()
 {
-    /* Produto do expoente  Π_{i | xᵢ=1} aᵢ  (mod Q) */
-    BigInt exponentProduct = 1;
-    /* Percorre os bits de x  (x = x₀, x₁, x₂, ...) */
-    for (unsigned bitIndex = 0; bitIndex < INPUT_DIMENSION; ++bitIndex)
-        if (boost::multiprecision::bit_test(inputVectorX_, bitIndex))
-            exponentProduct = (exponentProduct * fixedKeysA[bitIndex + 1])
-                              % subgroupOrderQ_; 
-
-    /* Base g^{a₀} (mod P) */
-    BigInt preComputedBase =
-        boost::multiprecision::powm(generatorG_,
-                                    fixedKeysA[0],
-                                    modulusP_);
-
-    /* Resultado final  (preBase)^{exponentProduct} (mod P) */
-    BigInt prfValue =
-        boost::multiprecision::powm(preComputedBase,
-                                    exponentProduct,
-                                    modulusP_);
-
-    /* Atualiza o vetor de entrada x  (x ← x+1) */
-    ++inputVectorX_;   
-    //                                            // x ← x+1
-    return static_cast<uint_fast32_t>(prfValue & 0xFFFFFFFFu);   // 32 bits
+    keygen_stats::add(&KeyGenerationStats::prngWords);
+    return evaluateAndAdvance();
+}
+
+void NaorReingoldPRF::fill(uint32_t* out, std::size_t count)
+{
+    keygen_stats::add(&KeyGenerationStats::prngWords, count);
+    /* Lotes grandes: avaliação por faixa e um único resetProducts() */
+    if (count >= (1u << LOW_BITS))
+    {
+        evaluateRange(inputVectorX_, count, out);
+        discard(count);
+        return;
+    }
+    for (std::size_t i = 0; i < count; ++i)
+        out[i] = evaluateAndAdvance();
+}
+
+void NaorReingoldPRF::evaluateRange(uint32_t firstX, std::size_t count, uint32_t* out) noexcept
+{
+    const FixedBaseTables& tables = fixedBase();
+    const auto& low = lowSubsetProducts();
+
+    uint32_t x = firstX;
+    while (count > 0)
+    {
+        /* Produto dos 24 bits altos: comum a todo o bloco de 256 */
+        uint64_t highProduct = 1;
+        for (uint32_t high = x >> LOW_BITS; high; high &= high - 1)
+            highProduct = mulModQ(highProduct,
+                                  fixedKeysA[LOW_BITS + __builtin_ctz(high) + 1]);
+
+        const unsigned first = x & ((1u << LOW_BITS) - 1);
+        const unsigned take  = static_cast<unsigned>(
+            std::min<std::size_t>(count, (1u << LOW_BITS) - first));
+        for (unsigned j = 0; j < take; ++j)
+            out[j] = tables.power(mulModQ(highProduct, low[first + j]));
+
+        out   += take;
+        count -= take;
+        x     += take;                                   // mod 2³², como inputVectorX_
+    }
+}
+
+void NaorReingoldPRF::discard(uint64_t count)
+{
+    inputVectorX_ += static_cast<uint32_t>(count);   // cada palavra consome um valor de x
+    resetProducts();
 }
 
 std::unique_ptr<PRNG> NaorReingoldPRF::clone() const
@@ -3,29 +3,45 @@
  *  Naor–Reingold PRF usada como PRNG determinístico.
  *  Parâmetros P, Q, G e chave a₀…aₙ são fixos (DiceForge demo).
  *  A seed controla apenas o valor de  x  (inputVectorX_).
+ *
+ *  P < 2³² e Q < 2²⁴: toda a aritmética é nativa (uint64_t). O expoente
+ *  Π aᵢ (mod Q) é mantido incrementalmente entre x e x+1, e  base^E
+ *  sai de tabelas de base fixa (janelas de 8 bits). Faixas inteiras de
+ *  x podem ser avaliadas em lote com evaluateRange().
  *──────────────────────────────────────────────────────────────*/
 #include "prng.h"
-#include <boost/multiprecision/cpp_int.hpp>
-#include <vector>
-
-using BigInt = boost::multiprecision::cpp_int;
+#include <array>
+#include <cstdint>
 
 class NaorReingoldPRF final : public PRNG
 {
     static constexpr unsigned INPUT_DIMENSION = 32;   // bits de x
 
-    /* Parâmetros do grupo */
-    const BigInt modulusP_;
-    const BigInt subgroupOrderQ_;
-    const BigInt generatorG_;
+    /* Estado === entrada x da PRF (só os 32 bits baixos entram em f) */
+    uint32_t inputVectorX_;
+
+    /* suffixProduct_[k] = Π_{i ≥ k, xᵢ = 1} a_{i+1}  (mod Q);
+       suffixProduct_[0] é o expoente de f(x). Ao incrementar x, só os
+       índices até o bit do "vai-um" mudam (2 em média). */
+    std::array<uint64_t, INPUT_DIMENSION + 1> suffixProduct_ {};
 
-    /* Estado === entrada x da PRF */
-    BigInt inputVectorX_;
+    /* Recalcula suffixProduct_ para o x corrente */
+    void resetProducts() noexcept;
+    /* f(x); avança x ← x+1 */
+    uint32_t evaluateAndAdvance() noexcept;
 
 public:
     explicit NaorReingoldPRF(uint_fast32_t initialSeed = 0);
 
     uint_fast32_t generate() override;            // 32 bits pseudo-aleatórios
+    void fill(uint32_t* out, std::size_t count) override;
+    void discard(uint64_t count) override;        // x ← x + count
     void setSeed(uint_fast32_t newSeed) override;
     std::unique_ptr<PRNG> clone() const override;
+
+    /* f(firstX), f(firstX+1), …, f(firstX+count-1)  em  out  (x mod 2³²).
+       Entradas de um mesmo bloco alinhado de 256 compartilham o produto
+       dos 24 bits altos; o byte baixo sai de uma tabela de subprodutos.
+       Sem estado: threads podem avaliar faixas disjuntas em paralelo. */
+    static void evaluateRange(uint32_t firstX, std::size_t count, uint32_t* out) noexcept;
 };
@@ -3,6 +3,8 @@
 // ──────────────────────────────────────────────
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 
@@ -22,6 +24,44 @@ public:
     /// Gera o próximo valor aleatório de 32 bits.
     [[nodiscard]] virtual uint_fast32_t generate() = 0;
 
+    /// Preenche  out[0..count)  com os próximos  count  valores de generate().
+    /// Implementações sobrescrevem com versões por bloco (sem chamada virtual
+    /// por palavra); a sequência produzida é a mesma de generate().
+    virtual void fill(uint32_t* out, std::size_t count)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+            out[i] = static_cast<uint32_t>(generate());
+    }
+
+    /// Preenche  count  bytes com as palavras de fill() em ordem
+    /// little-endian (o resto da última palavra é descartado).
+    void fillBytes(uint8_t* out, std::size_t count)
+    {
+        uint32_t words[64];
+        while (count > 0)
+        {
+            const std::size_t wordCount = std::min<std::size_t>(64, (count + 3) / 4);
+            fill(words, wordCount);
+            for (std::size_t i = 0; i < wordCount && count > 0; ++i)
+                for (unsigned byte = 0; byte < 4 && count > 0; ++byte, --count)
+                    *out++ = static_cast<uint8_t>(words[i] >> (8 * byte));
+        }
+    }
+
+    /// Avança o fluxo em  count  palavras, como  count  chamadas a generate().
+    /// A versão base gera e descarta; implementações com salto direto
+    /// (contador, jump-ahead) sobrescrevem com custo sublinear.
+    virtual void discard(uint64_t count)
+    {
+        uint32_t words[64];
+        while (count > 0)
+        {
+            const std::size_t take = static_cast<std::size_t>(std::min<uint64_t>(64, count));
+            fill(words, take);
+            count -= take;
+        }
+    }
+
     /// Define nova semente; implementações devem reinicializar estado interno.
     virtual void setSeed(uint_fast32_t newSeed) { seed_ = newSeed; }
 
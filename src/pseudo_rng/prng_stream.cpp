@@ -0,0 +1,131 @@
+// ──────────────────────────────────────────────
+// pseudo_rng/prng_stream.cpp
+// ──────────────────────────────────────────────
+#include "prng_stream.h"
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+/* Escreve  size  bytes (write parcial e EINTR repetem), somando em
+   written  o que saiu. false se o leitor fechou (EPIPE); demais erros
+   lançam std::system_error. */
+bool writeAll(int fileDescriptor, const char* data, std::size_t size, uint64_t& written)
+{
+    while (size > 0)
+    {
+        const ssize_t result = ::write(fileDescriptor, data, size);
+        if (result < 0)
+        {
+            if (errno == EINTR) continue;
+            if (errno == EPIPE) return false;
+            throw std::system_error(errno, std::generic_category(), "PrngStreamWriter: write");
+        }
+        data    += result;
+        size    -= static_cast<std::size_t>(result);
+        written += static_cast<uint64_t>(result);
+    }
+    return true;
+}
+} // namespace
+
+PrngStreamWriter::PrngStreamWriter(std::size_t bufferBytes)
+{
+    if (bufferBytes == 0)
+        throw std::invalid_argument("bufferBytes must be positive");
+    bufferBytes_ = (bufferBytes + BUFFER_ALIGNMENT - 1) / BUFFER_ALIGNMENT * BUFFER_ALIGNMENT;
+
+    for (Buffer& buffer : buffers_)
+    {
+        buffer.reset(static_cast<uint32_t*>(std::aligned_alloc(BUFFER_ALIGNMENT, bufferBytes_)));
+        if (!buffer) throw std::bad_alloc();
+    }
+}
+
+uint64_t PrngStreamWriter::stream(PRNG& prng, int fileDescriptor, uint64_t byteCount)
+{
+    /* Estado compartilhado dos dois buffers (protegido por mutex) */
+    struct Slot
+    {
+        std::size_t bytes {0};
+        bool        full  {false};
+    };
+    Slot slots[2];
+    std::mutex              mutex;
+    std::condition_variable changed;
+    bool                    producerDone  {false};
+    bool                    writerStopped {false};   // EPIPE ou erro
+    std::exception_ptr      writeError;
+    uint64_t                bytesWritten  {0};
+
+    /* Escritora: consome os buffers na mesma ordem em que foram cheios */
+    std::thread writer([&]
+    {
+        for (unsigned next = 0;; next ^= 1u)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [&] { return slots[next].full || producerDone; });
+            if (!slots[next].full) return;              // produtora terminou
+
+            const std::size_t bytes = slots[next].bytes;
+            lock.unlock();
+            bool keepGoing = false;
+            try {
+                keepGoing = writeAll(fileDescriptor,
+                                     reinterpret_cast<const char*>(buffers_[next].get()),
+                                     bytes, bytesWritten);   // só esta thread escreve nele
+            } catch (...) {
+                writeError = std::current_exception();
+            }
+            lock.lock();
+            slots[next].full = false;
+            if (!keepGoing) writerStopped = true;
+            changed.notify_all();
+            if (!keepGoing) return;
+        }
+    });
+
+    /* Produtora: enche o buffer livre enquanto o outro é escrito */
+    std::exception_ptr generateError;
+    try {
+        uint64_t remaining = byteCount;
+        for (unsigned next = 0; byteCount == 0 || remaining > 0; next ^= 1u)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [&] { return !slots[next].full || writerStopped; });
+                if (writerStopped) break;
+            }
+            const std::size_t bytes = byteCount == 0
+                ? bufferBytes_
+                : static_cast<std::size_t>(std::min<uint64_t>(bufferBytes_, remaining));
+            prng.fill(buffers_[next].get(), (bytes + 3) / 4);   // sobra da última palavra é descartada
+            remaining -= std::min<uint64_t>(remaining, bytes);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                slots[next] = {bytes, true};
+            }
+            changed.notify_all();
+        }
+    } catch (...) {
+        generateError = std::current_exception();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        producerDone = true;
+    }
+    changed.notify_all();
+    writer.join();
+
+    if (generateError) std::rethrow_exception(generateError);
+    if (writeError)    std::rethrow_exception(writeError);
+    return bytesWritten;
+}
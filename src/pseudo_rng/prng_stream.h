@@ -0,0 +1,53 @@
+// ──────────────────────────────────────────────
+// pseudo_rng/prng_stream.h
+// ──────────────────────────────────────────────
+#pragma once
+/*──────────────────────────────────────────────────────────────
+ *  PrngStreamWriter  –  saída bruta de um PRNG num descritor.
+ *
+ *  Dois buffers grandes e alinhados se alternam: a thread chamadora
+ *  preenche um com PRNG::fill() (caminho por bloco de cada gerador)
+ *  enquanto uma thread escritora despeja o outro com write(2). Assim
+ *  o gerador e o pipe trabalham em paralelo e a vazão medida é a do
+ *  mais lento dos dois, não a soma dos tempos.
+ *
+ *  Os bytes são as palavras de fill() em ordem little-endian, como
+ *  PRNG::fillBytes — adequados a baterias estatísticas externas.
+ *──────────────────────────────────────────────────────────────*/
+#include "prng.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+
+class PrngStreamWriter
+{
+public:
+    static constexpr std::size_t DEFAULT_BUFFER_BYTES = 8u << 20;   // por buffer
+    static constexpr std::size_t BUFFER_ALIGNMENT = 4096;           // página
+
+    /** bufferBytes é arredondado para múltiplo de BUFFER_ALIGNMENT. */
+    explicit PrngStreamWriter(std::size_t bufferBytes = DEFAULT_BUFFER_BYTES);
+
+    /**
+     * Gera e escreve  byteCount  bytes de  prng  em  fileDescriptor
+     * (0 ⇒ até o leitor fechar o pipe). Devolve os bytes escritos: menos
+     * que byteCount só se o leitor fechou (EPIPE). Outros erros de escrita
+     * viram std::system_error; exceções do PRNG são propagadas após a
+     * escritora terminar. Com SIGPIPE no padrão, fechar o pipe encerra o
+     * processo antes do EPIPE — ignore o sinal para um fim limpo.
+     */
+    uint64_t stream(PRNG& prng, int fileDescriptor, uint64_t byteCount = 0);
+
+    [[nodiscard]] std::size_t bufferBytes() const noexcept { return bufferBytes_; }
+
+private:
+    struct AlignedFree
+    {
+        void operator()(uint32_t* memory) const noexcept { std::free(memory); }
+    };
+    using Buffer = std::unique_ptr<uint32_t[], AlignedFree>;
+
+    std::size_t bufferBytes_;
+    Buffer      buffers_[2];
+};
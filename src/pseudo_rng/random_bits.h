@@ -0,0 +1,72 @@
+#pragma once
+/*──────────────────────────────────────────────────────────────
+ *  Inteiros aleatórios escritos direto nos limbs de um cpp_int.
+ *
+ *  As palavras de 32 bits de PRNG::fill() entram em ordem
+ *  little-endian (a i-ésima ocupa os bits [32i, 32i+32)) e a última
+ *  é truncada em  bits. O destino é redimensionado com resize(), que
+ *  só aloca se a capacidade atual não bastar: reaproveitando o mesmo
+ *  BigInt, a geração em regime não faz nenhuma alocação.
+ *──────────────────────────────────────────────────────────────*/
+#include "prng.h"
+#include <boost/multiprecision/cpp_int.hpp>
+#include <climits>
+#include <cstdint>
+#include <type_traits>
+
+using BigInt = boost::multiprecision::cpp_int;
+
+/* Escreve  bits  bits aleatórios em limbs[0..⌈bits/LIMB_BITS⌉), zerando o
+   excesso do limb mais alto. Generator pode ser o tipo concreto (final)
+   do PRNG: a chamada de fill() então é resolvida em tempo de compilação. */
+template <class Generator>
+inline void fillRandomLimbs(Generator& prng, unsigned bits,
+                            boost::multiprecision::limb_type* limbs)
+{
+    using Limb = boost::multiprecision::limb_type;
+    constexpr unsigned LIMB_BITS      = sizeof(Limb) * CHAR_BIT;
+    constexpr unsigned WORDS_PER_LIMB = LIMB_BITS / 32;
+    static_assert(LIMB_BITS == 32 || LIMB_BITS == 64, "limb de 32 ou 64 bits");
+
+    const unsigned limbCount = (bits + LIMB_BITS - 1) / LIMB_BITS;
+    const unsigned wordCount = (bits + 31) / 32;
+
+    if constexpr (WORDS_PER_LIMB == 1)
+        prng.fill(reinterpret_cast<uint32_t*>(limbs), wordCount);   // mesmo tipo
+    else
+    {
+        /* Blocos na pilha: 64 palavras = 32 limbs por chamada de fill() */
+        constexpr unsigned CHUNK_WORDS = 64;
+        uint32_t words[CHUNK_WORDS];
+        for (unsigned firstWord = 0; firstWord < wordCount; firstWord += CHUNK_WORDS)
+        {
+            const unsigned take = std::min(CHUNK_WORDS, wordCount - firstWord);
+            prng.fill(words, take);
+            for (unsigned w = 0; w < take; ++w)
+            {
+                const unsigned word = firstWord + w;
+                Limb& limb = limbs[word / WORDS_PER_LIMB];
+                if (word % WORDS_PER_LIMB == 0) limb = 0;
+                limb |= static_cast<Limb>(words[w]) << (32 * (word % WORDS_PER_LIMB));
+            }
+        }
+    }
+
+    if (const unsigned tailBits = bits % LIMB_BITS)
+        limbs[limbCount - 1] &= (Limb(1) << tailBits) - 1;
+}
+
+inline void fillRandomBits(PRNG& prng, unsigned bits, BigInt& out)
+{
+    using Limb = boost::multiprecision::limb_type;
+    constexpr unsigned LIMB_BITS = sizeof(Limb) * CHAR_BIT;
+
+    if (bits == 0) { out = 0; return; }
+
+    const unsigned limbCount = (bits + LIMB_BITS - 1) / LIMB_BITS;
+    auto& backend = out.backend();
+    backend.resize(limbCount, limbCount);
+    fillRandomLimbs(prng, bits, backend.limbs());
+    backend.sign(false);
+    backend.normalize();
+}
@@ -0,0 +1,92 @@
+/*──────────────────────────────────────────────────────────────
+ *  RsaKeyPairGenerator  –  p, q em paralelo e parâmetros CRT.
+ *──────────────────────────────────────────────────────────────*/
+#include "rsa_key_pair_generator.h"
+#include <stdexcept>
+#include <utility>
+
+namespace {
+/* a⁻¹ mod m  (Euclides estendido); lança se gcd(a, m) ≠ 1 */
+BigInt modularInverse(const BigInt& a, const BigInt& modulus)
+{
+    BigInt oldRemainder = a % modulus, remainder = modulus;
+    BigInt oldCoefficient = 1, coefficient = 0;
+    while (remainder != 0)
+    {
+        /* BigInt(...) força a avaliação: o template de expressão leria
+           remainder depois de std::exchange já tê-lo movido */
+        const BigInt quotient = oldRemainder / remainder;
+        oldRemainder   = std::exchange(remainder, BigInt(oldRemainder - quotient * remainder));
+        oldCoefficient = std::exchange(coefficient, BigInt(oldCoefficient - quotient * coefficient));
+    }
+    if (oldRemainder != 1)
+        throw std::invalid_argument("value is not invertible modulo the given modulus");
+    if (oldCoefficient < 0) oldCoefficient += modulus;
+    return oldCoefficient;
+}
+} // namespace
+
+RsaKeyPairGenerator::RsaKeyPairGenerator(std::unique_ptr<PRNG> prng,
+                                         PrimalityTest*        tester,
+                                         unsigned              modulusBits,
+                                         uint64_t              publicExponent,
+                                         int                   primalityIter)
+    : modulusBits_(modulusBits),
+      publicExponent_(publicExponent),
+      minimumDistanceBits_(modulusBits / 2 > 100 ? modulusBits / 2 - 100 : 0),
+      primeGenerator_(std::move(prng), tester, modulusBits / 2, primalityIter)
+{
+    if (modulusBits_ < 16 || modulusBits_ % 2 != 0)
+        throw std::invalid_argument("modulusBits must be even and ≥ 16");
+    if (publicExponent_ < 3 || publicExponent_ % 2 == 0)
+        throw std::invalid_argument("publicExponent must be odd and ≥ 3");
+
+    primeGenerator_.setCoprimeExponent(publicExponent_);
+    primeGenerator_.setTopBits(2);
+}
+
+void RsaKeyPairGenerator::setThreadPool(std::shared_ptr<WorkStealingPool> pool)
+{
+    primeGenerator_.setThreadPool(std::move(pool));
+}
+
+RsaKeyPair RsaKeyPairGenerator::generate(uint_fast32_t seed)
+{
+    const BigInt e = publicExponent_;
+    const BigInt minimumDistance = BigInt(1) << minimumDistanceBits_;
+    const BigInt minimumPrivateExponent = BigInt(1) << (modulusBits_ / 2);
+
+    RsaKeyPair key;
+    for (uint_fast32_t attempt = 0;; ++attempt)
+    {
+        /* A busca t da rodada usa  roundSeed + t: sementes espalhadas para
+           que pedidos com seeds vizinhas (ou outra tentativa) não
+           compartilhem buscas — e, portanto, primos */
+        const uint_fast32_t roundSeed = static_cast<uint32_t>(
+            (static_cast<uint64_t>(seed) * 0x9E3779B97F4A7C15ull + attempt * 0xBF58476D1CE4E5B9ull) >> 32);
+        KeyGenerationStats roundStats;
+        std::vector<BigInt> primes = primeGenerator_.generateKeysConcurrent(roundSeed, 2, &roundStats);
+        key.stats += roundStats;
+
+        BigInt& p = primes[0];
+        BigInt& q = primes[1];
+        if (p < q) std::swap(p, q);
+        if (p - q <= minimumDistance) continue;
+
+        /* λ(n) = mmc(p-1, q-1); gcd(e, λ) = 1 pelo filtro do gerador */
+        const BigInt pMinusOne = p - 1, qMinusOne = q - 1;
+        const BigInt lambda = pMinusOne / boost::multiprecision::gcd(pMinusOne, qMinusOne) * qMinusOne;
+        BigInt d = modularInverse(e, lambda);
+        if (d <= minimumPrivateExponent) continue;
+
+        key.n    = p * q;
+        key.e    = e;
+        key.dP   = d % pMinusOne;
+        key.dQ   = d % qMinusOne;
+        key.qInv = modularInverse(q, p);
+        key.d    = std::move(d);
+        key.p    = std::move(p);
+        key.q    = std::move(q);
+        return key;
+    }
+}
@@ -0,0 +1,57 @@
+// rsa_key_pair_generator.h
+#pragma once
+#include "key_generator.h"
+#include "keygen_stats.h"
+#include <boost/multiprecision/cpp_int.hpp>
+#include <cstdint>
+#include <memory>
+
+using BigInt = boost::multiprecision::cpp_int;
+
+/* Par de chaves RSA com os parâmetros CRT (PKCS #1): p > q */
+struct RsaKeyPair
+{
+    BigInt n, e, d;
+    BigInt p, q;
+    BigInt dP, dQ, qInv;       // d mod (p-1), d mod (q-1), q⁻¹ mod p
+    KeyGenerationStats stats;  // trabalho da busca de p e q (ver keygen_stats.h)
+};
+
+/* =========================================================================
+   Gera pares de chaves RSA de  modulusBits  bits sobre um KeyGenerator.
+   -------------------------------------------------------------------------
+   p e q saem de uma única rodada concorrente (generateKeysConcurrent): as
+   buscas do pool correm juntas e os dois primeiros primos viram p e q.
+   O gerador de primos é configurado para que nenhum primo seja jogado
+   fora depois: candidatos com gcd(p-1, e) ≠ 1 caem antes dos testes, e os
+   dois bits altos fixos garantem que n tenha exatamente modulusBits bits.
+   O par só é refeito nos casos de probabilidade desprezível: |p-q| abaixo
+   do limite ou d ≤ 2^(modulusBits/2) (FIPS 186-4, B.3.1).
+   d = e⁻¹ mod λ(n),  λ(n) = mmc(p-1, q-1).
+   ========================================================================= */
+class RsaKeyPairGenerator
+{
+public:
+    static constexpr uint64_t DEFAULT_PUBLIC_EXPONENT = 65537;
+
+    RsaKeyPairGenerator(std::unique_ptr<PRNG> prng,
+                        PrimalityTest* tester,
+                        unsigned modulusBits = 2048,
+                        uint64_t publicExponent = DEFAULT_PUBLIC_EXPONENT,
+                        int primalityIter = 64);
+
+    // Pool compartilhado com outros geradores (ver KeyGenerator)
+    void setThreadPool(std::shared_ptr<WorkStealingPool> pool);
+    // |p - q| > 2^bits. Padrão: modulusBits/2 - 100 (0 em módulos pequenos)
+    void setMinimumPrimeDistanceBits(unsigned bits) noexcept { minimumDistanceBits_ = bits; }
+    // Gerador de primos subjacente (modo de busca, determinismo, fluxos)
+    [[nodiscard]] KeyGenerator& primeGenerator() noexcept { return primeGenerator_; }
+
+    [[nodiscard]] RsaKeyPair generate(uint_fast32_t seed);
+
+private:
+    unsigned     modulusBits_;
+    uint64_t     publicExponent_;
+    unsigned     minimumDistanceBits_;
+    KeyGenerator primeGenerator_;
+};
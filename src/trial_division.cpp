@@ -0,0 +1,250 @@
+/*──────────────────────────────────────────────────────────────
+ *  TrialDivisionEngine  –  divisão por tentativa em blocos.
+ *
+ *  Para r < 2⁶⁴ e p ímpar:   p | r   ⇔   r · p⁻¹ (mod 2⁶⁴) ≤ ⌊(2⁶⁴-1)/p⌋
+ *  (Granlund–Montgomery). Cada bloco custa uma única passada pelos
+ *  limbs de n, com o recíproco do produto calculado na construção
+ *  (divisão 2-por-1 de Möller–Granlund, sem instrução de divisão); o
+ *  resto do trabalho é aritmética nativa.
+ *──────────────────────────────────────────────────────────────*/
+#include "trial_division.h"
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+#if defined(__SIZEOF_INT128__)
+__extension__ typedef unsigned __int128 UInt128;
+#endif
+
+/* Crivo de Eratóstenes simples para a tabela de primos ímpares */
+std::vector<uint32_t> oddPrimesUpTo(uint32_t bound)
+{
+    std::vector<bool> composite(bound + 1, false);
+    std::vector<uint32_t> primes;
+    for (uint64_t i = 3; i <= bound; i += 2)
+    {
+        if (composite[i]) continue;
+        primes.push_back(static_cast<uint32_t>(i));
+        for (uint64_t j = i * i; j <= bound; j += 2 * i) composite[j] = true;
+    }
+    return primes;
+}
+
+/* Inverso de p (ímpar) módulo 2⁶⁴ por Newton: cada passo dobra os bits */
+constexpr uint64_t inverseMod2to64(uint64_t p) noexcept
+{
+    uint64_t inverse = p;                        // correto em 3 bits
+    for (int i = 0; i < 5; ++i) inverse *= 2 - p * inverse;
+    return inverse;
+}
+
+using Limb = boost::multiprecision::limb_type;
+
+#if defined(__SIZEOF_INT128__)
+/* Recíproco de d normalizado (bit 63 ligado): v = ⌊(2¹²⁸-1)/d⌋ - 2⁶⁴.
+   Uma divisão 128/64 por bloco, feita uma vez na construção */
+uint64_t reciprocalOf(uint64_t d) noexcept
+{
+    return static_cast<uint64_t>(((static_cast<UInt128>(~d) << 64) | ~uint64_t{0}) / d);
+}
+
+/* ⟨u1,u0⟩ mod d  (u1 < d, d normalizado) com o recíproco v — divisão 2-por-1
+   de Möller–Granlund: duas multiplicações e no máximo duas correções */
+inline uint64_t remainder2by1(uint64_t u1, uint64_t u0, uint64_t d, uint64_t v) noexcept
+{
+    const UInt128 q = static_cast<UInt128>(v) * u1 + ((static_cast<UInt128>(u1) << 64) | u0);
+    const uint64_t q1 = static_cast<uint64_t>(q >> 64) + 1;
+    const uint64_t q0 = static_cast<uint64_t>(q);
+    uint64_t r = u0 - q1 * d;                          // mod 2⁶⁴
+    r += d & (0 - static_cast<uint64_t>(r > q0));      // frequente: sem desvio
+    if (__builtin_expect(r >= d, 0)) r -= d;           // raro
+    return r;
+}
+#endif
+
+/* n mod m  numa única passada pelos limbs (do mais significativo), sem 128 bits:
+   Horner bit a bit com dobra modular (r < m < 2⁶⁴) */
+[[maybe_unused]] uint64_t reduceModuloBitwise(const Limb* limbs, std::size_t count,
+                                              uint64_t m) noexcept
+{
+    uint64_t remainder = 0;
+    for (std::size_t i = count; i-- > 0;)
+        for (int bit = std::numeric_limits<Limb>::digits - 1; bit >= 0; --bit)
+        {
+            remainder = (remainder >= m - remainder) ? remainder - (m - remainder)
+                                                     : remainder + remainder;
+            if ((limbs[i] >> bit) & 1u)
+                remainder = (remainder == m - 1) ? 0 : remainder + 1;
+        }
+    return remainder;
+}
+
+/* residues[j] = n mod blocks[j].product  para LANES blocos, numa passada pelos
+   limbs. Com 128 bits, n é deslocado junto com o divisor em vez de dividido,
+   (n·2ˢ) mod (m·2ˢ) = (n mod m)·2ˢ, e cada passo é uma divisão 2-por-1 pelo
+   recíproco. Cada bloco é uma cadeia dependente (o resto alimenta o passo
+   seguinte); várias cadeias juntas escondem a latência das multiplicações. */
+template <std::size_t LANES, class Block>
+void reduceBlocks(const Limb* limbs, std::size_t count, const Block* blocks,
+                  uint64_t* residues) noexcept
+{
+#if defined(__SIZEOF_INT128__)
+    static_assert(std::numeric_limits<Limb>::digits == 64, "limbs de 64 bits");
+    uint64_t divisor[LANES], remainder[LANES];
+    for (std::size_t j = 0; j < LANES; ++j)
+    {
+        const unsigned shift = blocks[j].shift;
+        divisor[j]   = blocks[j].product << shift;
+        /* Bits que sobem do limb do topo: < 2ˢ ≤ 2⁶³ < divisor */
+        remainder[j] = (count && shift) ? limbs[count - 1] >> (64 - shift) : 0;
+    }
+    for (std::size_t i = count; i-- > 0;)
+        for (std::size_t j = 0; j < LANES; ++j)
+        {
+            const unsigned shift = blocks[j].shift;
+            const uint64_t lower = i ? limbs[i - 1] : 0;
+            const uint64_t word  = shift ? (limbs[i] << shift) | (lower >> (64 - shift))
+                                         : limbs[i];
+            remainder[j] = remainder2by1(remainder[j], word, divisor[j], blocks[j].reciprocal);
+        }
+    for (std::size_t j = 0; j < LANES; ++j)
+        residues[j] = remainder[j] >> blocks[j].shift;
+#else
+    for (std::size_t j = 0; j < LANES; ++j)
+        residues[j] = reduceModuloBitwise(limbs, count, blocks[j].product);
+#endif
+}
+
+/* Blocos reduzidos juntos por reduceBlocks */
+constexpr std::size_t BLOCK_LANES = 4;
+
+} // namespace
+
+TrialDivisionEngine::TrialDivisionEngine(uint32_t primeBound)
+    : primeBound_(primeBound),
+      oddPrimes_(oddPrimesUpTo(primeBound))
+{
+    if (primeBound_ < 3)
+        throw std::invalid_argument("primeBound must be ≥ 3");
+
+    entries_.reserve(oddPrimes_.size());
+    for (uint32_t p : oddPrimes_)
+        entries_.push_back({inverseMod2to64(p),
+                            std::numeric_limits<uint64_t>::max() / p});
+
+    /* Agrupa primos consecutivos enquanto o produto couber em 64 bits */
+    for (uint32_t i = 0; i < oddPrimes_.size();)
+    {
+        PrimorialBlock block{1, i, 0, 0, 0};
+        while (i < oddPrimes_.size() &&
+               block.product <= std::numeric_limits<uint64_t>::max() / oddPrimes_[i])
+        {
+            block.product *= oddPrimes_[i++];
+            ++block.count;
+        }
+#if defined(__SIZEOF_INT128__)
+        block.shift      = static_cast<uint32_t>(__builtin_clzll(block.product));
+        block.reciprocal = reciprocalOf(block.product << block.shift);
+#endif
+        blocks_.push_back(block);
+    }
+}
+
+const uint32_t* TrialDivisionEngine::findDivisor(const PrimorialBlock& block,
+                                                 uint64_t residue) const noexcept
+{
+    for (uint32_t i = block.first; i < block.first + block.count; ++i)
+    {
+        const PrimeEntry& entry = entries_[i];
+        if (residue * entry.inverse <= entry.limit)          // p | n
+            return &oddPrimes_[i];
+    }
+    return nullptr;
+}
+
+template <class Visit>
+bool TrialDivisionEngine::forEachBlockResidue(const boost::multiprecision::limb_type* limbs,
+                                              std::size_t count, Visit visit) const
+{
+    const std::size_t total = blocks_.size();
+    uint64_t residues[BLOCK_LANES];
+
+    /* O 1º bloco (3, 5, 7, …) sozinho: a maioria dos compostos para nele */
+    reduceBlocks<1>(limbs, count, &blocks_[0], residues);   // primeBound ≥ 3: existe
+    if (visit(blocks_[0], residues[0])) return true;
+
+    std::size_t b = 1;
+    for (; b + BLOCK_LANES <= total; b += BLOCK_LANES)
+    {
+        reduceBlocks<BLOCK_LANES>(limbs, count, &blocks_[b], residues);
+        for (std::size_t j = 0; j < BLOCK_LANES; ++j)
+            if (visit(blocks_[b + j], residues[j])) return true;
+    }
+    for (; b < total; ++b)
+    {
+        reduceBlocks<1>(limbs, count, &blocks_[b], residues);
+        if (visit(blocks_[b], residues[0])) return true;
+    }
+    return false;
+}
+
+bool TrialDivisionEngine::isComposite(const BigInt& n) const noexcept
+{
+    if (n <= 1) return n == 0;
+    if (!boost::multiprecision::bit_test(n, 0)) return n != 2; // par (sem temporário)
+
+    /* n pequeno pode ser um dos próprios primos da tabela */
+    if (boost::multiprecision::msb(n) < 64)
+    {
+        const uint64_t nWord = static_cast<uint64_t>(n);
+        for (const PrimorialBlock& block : blocks_)
+            if (const uint32_t* divisor = findDivisor(block, nWord % block.product))
+                return nWord != *divisor;
+        return false;
+    }
+    return hasSmallFactor(n.backend().limbs(), n.backend().size());
+}
+
+bool TrialDivisionEngine::hasSmallFactor(const boost::multiprecision::limb_type* limbs,
+                                         std::size_t count) const noexcept
+{
+    return forEachBlockResidue(limbs, count, [this](const PrimorialBlock& block, uint64_t residue)
+    {
+        return findDivisor(block, residue) != nullptr;
+    });
+}
+
+void TrialDivisionEngine::computeResidues(const BigInt& n,
+                                          std::vector<uint32_t>& residues) const
+{
+    residues.resize(oddPrimes_.size());
+    forEachBlockResidue(n.backend().limbs(), n.backend().size(),
+                        [&](const PrimorialBlock& block, uint64_t residue)
+    {
+        for (uint32_t i = block.first; i < block.first + block.count; ++i)
+            residues[i] = static_cast<uint32_t>(residue % oddPrimes_[i]);
+        return false;
+    });
+}
+
+uint32_t TrialDivisionEngine::recommendedPrimeBound(unsigned bits) noexcept
+{
+    if (bits <= 512)  return DEFAULT_PRIME_BOUND;
+    if (bits <= 1024) return 1u << 12;
+    if (bits <= 2048) return 1u << 14;
+    return 1u << 16;
+}
+
+const TrialDivisionEngine& TrialDivisionEngine::forBits(unsigned bits)
+{
+    static const TrialDivisionEngine small(recommendedPrimeBound(512));
+    static const TrialDivisionEngine medium(recommendedPrimeBound(1024));
+    static const TrialDivisionEngine large(recommendedPrimeBound(2048));
+    static const TrialDivisionEngine huge(recommendedPrimeBound(4096));
+
+    if (bits <= 512)  return small;
+    if (bits <= 1024) return medium;
+    if (bits <= 2048) return large;
+    return huge;
+}
@@ -0,0 +1,83 @@
+// trial_division.h  ───────────────────────────────────────────────
+#pragma once
+#include "keygen_stats.h"
+#include <boost/multiprecision/cpp_int.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using BigInt = boost::multiprecision::cpp_int;
+
+/* =========================================================================
+   Divisão por tentativa via resíduos de primoriais.
+   -------------------------------------------------------------------------
+   Os primos ímpares até  primeBound  são agrupados em blocos cujo produto
+   cabe em 64 bits. n é reduzido uma única vez por bloco (n mod Π bloco) e
+   as checagens de divisibilidade seguintes rodam sobre resíduos uint64_t,
+   usando o inverso de p módulo 2⁶⁴ (sem instrução de divisão).
+   ========================================================================= */
+class TrialDivisionEngine
+{
+public:
+    static constexpr uint32_t DEFAULT_PRIME_BOUND = 1000;
+
+    explicit TrialDivisionEngine(uint32_t primeBound = DEFAULT_PRIME_BOUND);
+
+    // true se n tiver divisor primo ≤ primeBound e n não for esse primo.
+    [[nodiscard]] bool isComposite(const BigInt& n) const noexcept;
+
+    // Mesmo teste direto sobre limbs (little-endian) de um n ímpar ≥ 2⁶⁴,
+    // p.ex. o backend de largura fixa: true se houver divisor ≤ primeBound.
+    [[nodiscard]] bool hasSmallFactor(const boost::multiprecision::limb_type* limbs,
+                                      std::size_t count) const noexcept;
+
+    // residues[i] = n mod oddPrimes()[i]  (uma redução de BigInt por bloco)
+    void computeResidues(const BigInt& n, std::vector<uint32_t>& residues) const;
+
+    [[nodiscard]] const std::vector<uint32_t>& oddPrimes() const noexcept
+    { return oddPrimes_; }
+    [[nodiscard]] uint32_t primeBound() const noexcept { return primeBound_; }
+
+    // Limite sugerido para candidatos de  bits  bits (997 … 2¹⁶).
+    [[nodiscard]] static uint32_t recommendedPrimeBound(unsigned bits) noexcept;
+    // Instância compartilhada (imutável) com o limite recomendado.
+    [[nodiscard]] static const TrialDivisionEngine& forBits(unsigned bits);
+
+private:
+    struct PrimeEntry
+    {
+        uint64_t inverse;    // p⁻¹ mod 2⁶⁴
+        uint64_t limit;      // ⌊(2⁶⁴-1)/p⌋ : r·p⁻¹ ≤ limit  ⇔  p | r
+    };
+    struct PrimorialBlock
+    {
+        uint64_t product;    // Π p  do bloco (< 2⁶⁴)
+        uint32_t first;      // índice do primeiro primo em oddPrimes_
+        uint32_t count;
+        uint32_t shift;      // clz(product): product << shift tem o bit 63 ligado
+        uint64_t reciprocal; // ⌊(2¹²⁸-1)/(product << shift)⌋ - 2⁶⁴ (Möller–Granlund)
+    };
+
+    // Primo do bloco que divide o resíduo (em oddPrimes_), ou nullptr
+    const uint32_t* findDivisor(const PrimorialBlock& block, uint64_t residue) const noexcept;
+    // visit(bloco, n mod produto) em ordem até visit devolver true (→ true)
+    template <class Visit>
+    bool forEachBlockResidue(const boost::multiprecision::limb_type* limbs,
+                             std::size_t count, Visit visit) const;
+
+    uint32_t primeBound_;
+    std::vector<uint32_t>       oddPrimes_;
+    std::vector<PrimeEntry>     entries_;
+    std::vector<PrimorialBlock> blocks_;
+};
+
+// Verifica se n é divisível por algum primo pequeno (limite escolhido pelo
+// tamanho de n). Retorna true se n for composto, false caso contrário.
+inline bool isCompositeByTrialDivision(const BigInt& n)
+{
+    if (n <= 1) return n == 0;
+    const bool composite = TrialDivisionEngine::forBits(boost::multiprecision::msb(n) + 1)
+        .isComposite(n);
+    if (composite) keygen_stats::add(&KeyGenerationStats::trialDivisionRejects);
+    return composite;
+}
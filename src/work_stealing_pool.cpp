@@ -0,0 +1,124 @@
+/*──────────────────────────────────────────────────────────────
+ *  WorkStealingPool
+ *──────────────────────────────────────────────────────────────*/
+#include "work_stealing_pool.h"
+#include <algorithm>
+#include <exception>
+
+namespace {
+/* Identifica o worker corrente para que submit() use a fila local */
+thread_local const WorkStealingPool* currentPool = nullptr;
+thread_local unsigned                currentIndex = 0;
+}
+
+unsigned WorkStealingPool::defaultThreadCount() noexcept
+{
+    return std::max(1u, std::thread::hardware_concurrency() / 2);
+}
+
+WorkStealingPool::WorkStealingPool(unsigned threadCount)
+{
+    if (threadCount == 0) threadCount = defaultThreadCount();
+
+    queues_.reserve(threadCount);
+    for (unsigned i = 0; i < threadCount; ++i)
+        queues_.push_back(std::make_unique<WorkerQueue>());
+
+    workers_.reserve(threadCount);
+    for (unsigned i = 0; i < threadCount; ++i)
+        workers_.emplace_back(&WorkStealingPool::workerLoop, this, i);
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        stopping_ = true;
+    }
+    wakeUp_.notify_all();
+    for (auto& worker : workers_)
+        if (worker.joinable()) worker.join();
+}
+
+std::future<void> WorkStealingPool::submit(Task task)
+{
+    auto promise = std::make_shared<std::promise<void>>();
+    std::future<void> result = promise->get_future();
+
+    Task wrapped = [job = std::move(task), promise](unsigned workerIndex)
+    {
+        try {
+            job(workerIndex);
+            promise->set_value();
+        } catch (...) {
+            promise->set_exception(std::current_exception());
+        }
+    };
+
+    const unsigned target = (currentPool == this)
+        ? currentIndex
+        : nextQueue_.fetch_add(1, std::memory_order_relaxed) % size();
+    {
+        std::lock_guard<std::mutex> lock(queues_[target]->mutex);
+        queues_[target]->tasks.push_back(std::move(wrapped));
+    }
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        pending_.fetch_add(1, std::memory_order_release);
+    }
+    wakeUp_.notify_one();
+    return result;
+}
+
+bool WorkStealingPool::popLocal(unsigned index, Task& task)
+{
+    WorkerQueue& queue = *queues_[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) return false;
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool WorkStealingPool::steal(unsigned thief, Task& task)
+{
+    const unsigned count = size();
+    for (unsigned offset = 1; offset < count; ++offset)
+    {
+        /* Lock bloqueante: a seção crítica é um pop de deque. Com try_lock,
+           uma fila disputada era pulada e, como pending_ > 0, o wait de
+           workerLoop voltava na hora — o worker ocioso girava em falso */
+        WorkerQueue& victim = *queues_[(thief + offset) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (victim.tasks.empty()) continue;
+        task = std::move(victim.tasks.front());
+        victim.tasks.pop_front();
+        return true;
+    }
+    return false;
+}
+
+void WorkStealingPool::workerLoop(unsigned index)
+{
+    currentPool  = this;
+    currentIndex = index;
+
+    Task task;
+    while (true)
+    {
+        if (popLocal(index, task) || steal(index, task))
+        {
+            pending_.fetch_sub(1, std::memory_order_acq_rel);
+            task(index);
+            task = nullptr;
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        wakeUp_.wait(lock, [this] {
+            return stopping_ || pending_.load(std::memory_order_acquire) > 0;
+        });
+        if (stopping_ && pending_.load(std::memory_order_acquire) == 0)
+            return;
+    }
+}
@@ -0,0 +1,64 @@
+#pragma once
+/*──────────────────────────────────────────────────────────────
+ *  WorkStealingPool  –  threads persistentes com fila por worker.
+ *
+ *  Cada worker consome a própria fila pelo fim (LIFO) e, quando
+ *  ela esvazia, rouba do início da fila dos outros (FIFO). Tarefas
+ *  submetidas de dentro de um worker vão para a fila dele; de fora,
+ *  são distribuídas em round-robin.
+ *
+ *  A tarefa recebe o índice do worker que a executa (0 … size()-1),
+ *  o que permite ao chamador manter estado por worker (PRNG, buffers)
+ *  entre submissões sem sincronização extra.
+ *──────────────────────────────────────────────────────────────*/
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class WorkStealingPool
+{
+public:
+    using Task = std::function<void(unsigned workerIndex)>;
+
+    /** threadCount = 0 ⇒ defaultThreadCount(). */
+    explicit WorkStealingPool(unsigned threadCount = 0);
+    ~WorkStealingPool();                                 // drena as filas e junta as threads
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    [[nodiscard]] unsigned size() const noexcept
+    { return static_cast<unsigned>(queues_.size()); }   // fixo antes das threads nascerem
+
+    /** Enfileira a tarefa; o future propaga exceções lançadas por ela. */
+    std::future<void> submit(Task task);
+
+    /** Metade das threads de hardware (mínimo 1), como o gerador usava. */
+    [[nodiscard]] static unsigned defaultThreadCount() noexcept;
+
+private:
+    struct WorkerQueue
+    {
+        std::mutex       mutex;
+        std::deque<Task> tasks;
+    };
+
+    void workerLoop(unsigned index);
+    bool popLocal(unsigned index, Task& task);
+    bool steal(unsigned thief, Task& task);
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues_;
+    std::vector<std::thread>                  workers_;
+
+    std::mutex              sleepMutex_;
+    std::condition_variable wakeUp_;
+    std::atomic<std::size_t> pending_ {0};               // tarefas enfileiradas, não retiradas
+    std::atomic<unsigned>    nextQueue_ {0};             // round-robin de submissões externas
+    bool stopping_ {false};
+};